@@ -3,11 +3,14 @@ import 'dart:typed_data';
 import 'package:flutter/material.dart';
 import 'package:flutter/foundation.dart' show kDebugMode;
 import 'package:tuple/tuple.dart';
+import 'package:sudoku_scanner/sudoku_scanner.dart';
 
 enum BoardStatus {
   inProgress,
   solved,
   hasErrors,
+  // scanned grid has no or several solutions, likely a misread digit
+  badScan,
 }
 
 class SudokuGrid extends ChangeNotifier {
@@ -34,6 +37,12 @@ class SudokuGrid extends ChangeNotifier {
         return SudokuGridCell(id, row, col, value);
       }, growable: false);
     });
+
+    // Flag scans that can't be solved unambiguously right away.
+    if (SudokuScanner.countSolutions(valueList) != 1) {
+      _status = BoardStatus.badScan;
+      notifyListeners();
+    }
   }
 
   int getValue(int row, int col) {
@@ -150,23 +159,23 @@ class SudokuGrid extends ChangeNotifier {
     select(row, col, update: true);
   }
 
-  /// Based on http://norvig.com/sudoku.html
   bool solve() {
     if (_cellList == null) return false;
-    // Assign static values.
-    // TODO: maybe do this in constructor of SudokuGrid?
+    // Only static values count, user input may be wrong.
+    final valueList = Uint8List(81);
     for (final row in _cellList!) {
       for (final cell in row.where((cell) => !cell.isModifiable)) {
-        if (!_assign(cell, cell.value, [])) return false;
+        valueList[cell.id] = cell.value;
       }
     }
 
-    if (!_search()) return false;
+    final solution = SudokuScanner.solveGrid(valueList);
+    if (solution == null) return false;
 
     // Change actual values of Sudoku grid.
     for (final row in _cellList!) {
       for (final cell in row) {
-        cell.value = cell.possibilities.first;
+        cell.value = solution[cell.id];
       }
     }
 
@@ -183,90 +192,6 @@ class SudokuGrid extends ChangeNotifier {
     return true;
   }
 
-  bool _assign(
-      SudokuGridCell cell, int value, List<SudokuGridCell>? backtrackList) {
-    final otherValues = Set<int>.from(cell.possibilities);
-    otherValues.remove(value);
-
-    return otherValues.every((value) => _eliminate(cell, value, backtrackList));
-  }
-
-  bool _eliminate(
-      SudokuGridCell cell, int value, List<SudokuGridCell>? backtrackList) {
-    bool doBacktrack = backtrackList != null;
-    // Already eliminated.
-    if (!cell.eliminatePosibility(value, backtrack: doBacktrack)) return true;
-
-    if (doBacktrack) backtrackList.add(cell);
-
-    if (cell.possibilities.isEmpty) {
-      // Contradiction: removed last value.
-      return false;
-    } else if (cell.possibilities.length == 1) {
-      final possibleValues = cell.possibilities;
-
-      if (!possibleValues.every((value) => _actOnUnits(
-            cell,
-            (cell) => _eliminate(cell, value, backtrackList),
-            onlyPeers: true,
-          ))) {
-        return false;
-      }
-    }
-
-    // Check if value can only be asigned to one cell.
-    List<SudokuGridCell> valuePlaces = [];
-    _actOnUnits(cell, (cell) {
-      if (cell.possibilities.contains(value)) valuePlaces.add(cell);
-      return true;
-    });
-
-    if (valuePlaces.isEmpty) {
-      // Contradiction: no place for this value.
-      return false;
-    } else if (valuePlaces.length == 1) {
-      if (!_assign(valuePlaces[0], value, backtrackList)) return false;
-    }
-    return true;
-  }
-
-  bool _search() {
-    assert(_cellList != null);
-    // Check if Sudoku already solved.
-    if (_cellList!
-        .every((row) => row.every((cell) => cell.possibilities.length == 1))) {
-      return true;
-    }
-
-    // Get cell with fewest possibilities.
-    SudokuGridCell? nextCell;
-    for (final row in _cellList!) {
-      for (final cell in row.where((cell) => cell.possibilities.length > 1)) {
-        if (nextCell == null ||
-            cell.possibilities.length < nextCell.possibilities.length) {
-          nextCell = cell;
-        }
-      }
-    }
-
-    // At least one cell has empty possibilities.
-    if (nextCell == null) return false;
-
-    final possibilities = Set<int>.from(nextCell.possibilities);
-
-    // Try to assign one of the possible values.
-    for (final value in possibilities) {
-      List<SudokuGridCell> backtrackList = [];
-      if (_assign(nextCell, value, backtrackList) && _search()) return true;
-
-      for (final cell in backtrackList) {
-        cell.backtrackPosibilities();
-      }
-    }
-    // None of the possible assignments worked.
-    return false;
-  }
-
   bool _actOnUnits(
       SudokuGridCell cell, bool Function(SudokuGridCell cell) action,
       {bool onlyPeers = false}) {
@@ -372,8 +297,6 @@ class SudokuGridCell {
   final int _col;
   final int _blockId;
   final bool _isModifiable;
-  final _backtrackQueue = Queue<int>();
-  final Set<int> _possibilities = {1, 2, 3, 4, 5, 6, 7, 8, 9};
   int _value;
   CellStatus status = CellStatus.none;
 
@@ -381,25 +304,12 @@ class SudokuGridCell {
       : _isModifiable = (_value == 0),
         _blockId = (_row ~/ 3) * 3 + _col ~/ 3;
 
-  bool eliminatePosibility(int value, {bool backtrack = true}) {
-    if (!_possibilities.remove(value)) return false;
-
-    if (backtrack) _backtrackQueue.addLast(value);
-    return true;
-  }
-
-  void backtrackPosibilities() {
-    assert(_backtrackQueue.isNotEmpty);
-    _possibilities.add(_backtrackQueue.removeLast());
-  }
-
   int get id => _id;
   int get row => _row;
   int get col => _col;
   int get blockId => _blockId;
   bool get isModifiable => _isModifiable;
   int get value => _value;
-  Set<int> get possibilities => _possibilities;
 
   set value(int value) {
     assert(0 <= value && value < 10);
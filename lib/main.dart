@@ -1,3 +1,4 @@
+import 'package:flutter/foundation.dart' show kDebugMode;
 import 'package:flutter/material.dart';
 import 'package:flutter/services.dart';
 import 'package:sudoku_scanner/sudoku_scanner.dart';
@@ -24,6 +25,7 @@ void main() async {
 
   // Initialize SudokuScanner
   await SudokuScanner.init();
+  if (kDebugMode) debugPrint('${SudokuScanner.getBackendInfo()}');
 
   runApp(MaterialApp(
     theme: ThemeData(
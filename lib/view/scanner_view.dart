@@ -2,6 +2,7 @@ import 'dart:async';
 import 'dart:io';
 import 'dart:typed_data';
 import 'dart:ui' as ui;
+import 'package:flutter/foundation.dart' show kDebugMode;
 import 'package:flutter/material.dart';
 import 'package:sudoku_scanner/sudoku_scanner.dart';
 import 'package:sudoku_scanner/bounding_box.dart';
@@ -24,6 +25,8 @@ class ScannerView extends StatefulWidget {
 
 class _ScannerViewState extends State<ScannerView> {
   late Future<ui.Image> _imageFuture;
+  late Future<ScanSession?> _sessionFuture;
+  late Future<void> _detectionFuture;
   late Future<void> _firstBuildFuture;
 
   List<Offset> _points = [];
@@ -47,7 +50,12 @@ class _ScannerViewState extends State<ScannerView> {
 
     _imageFuture = _getUiImage(widget.imagePath);
 
-    SudokuScanner.detectGrid(widget.imagePath).then(_onScanComplete);
+    // Decode image only once for detection and extraction.
+    _sessionFuture = SudokuScanner.openSession(widget.imagePath);
+    _detectionFuture = _sessionFuture
+        .then((session) =>
+            session?.detectGrid() ?? SudokuScanner.detectGrid(widget.imagePath))
+        .then(_onScanComplete);
 
     super.initState();
   }
@@ -235,6 +243,9 @@ class _ScannerViewState extends State<ScannerView> {
           children: <Widget>[
             ElevatedButton(
               onPressed: () {
+                // Session may only be freed once detection is done with it.
+                _detectionFuture.whenComplete(
+                    () => _sessionFuture.then((session) => session?.close()));
                 // delete image from cache
                 File(widget.imagePath).delete();
                 return widget.onBack();
@@ -261,9 +272,13 @@ class _ScannerViewState extends State<ScannerView> {
 
                 final boundingBox =
                     BoundingBox.fromPoints(relativePoints, _previewSize!);
-                final valueList =
-                    SudokuScanner.extractGrid(widget.imagePath, boundingBox)
-                        .then((valueList) {
+                final session = await _sessionFuture;
+                final valueList = (session?.extractGrid(boundingBox) ??
+                        SudokuScanner.extractGrid(
+                            widget.imagePath, boundingBox))
+                    .then((valueList) {
+                  if (kDebugMode) debugPrint("${SudokuScanner.getScanStats()}");
+                  session?.close();
                   // delete image from cache
                   File(widget.imagePath).delete();
                   return valueList;
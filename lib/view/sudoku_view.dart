@@ -134,6 +134,11 @@ class _SudokuViewState extends State<SudokuView> {
                         icon = Icons.close;
                         text = " Wrong";
                         break;
+                      case BoardStatus.badScan:
+                        color = Colors.orange[700];
+                        icon = Icons.warning_amber;
+                        text = " Check scan";
+                        break;
                     }
                     return Container(
                       padding: const EdgeInsets.all(7.0),
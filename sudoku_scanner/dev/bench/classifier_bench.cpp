@@ -0,0 +1,70 @@
+#include <benchmark/benchmark.h>
+
+#include <cstdio>
+#include <opencv2/imgproc.hpp>
+#include <string>
+#include <vector>
+
+#include "extraction/classification/number_classifier.hpp"
+#include "extraction/structs/cell.hpp"
+
+const std::string MODEL_PATH = std::string(CMAKE_ASSETS_PATH) + "/model.tflite";
+
+NumberClassifier classifier;
+
+// printed digits on white background, roughly what extract_cells hands over
+std::vector<Cell> make_cells(int count) {
+    std::vector<Cell> cells;
+
+    for (int i = 0; i < count; ++i) {
+        cv::Mat img(50, 50, CV_8UC1, cv::Scalar(255));
+        cv::putText(img, std::to_string(i % 9 + 1), cv::Point(12, 40), cv::FONT_HERSHEY_SIMPLEX, 1.4, cv::Scalar(0), 3);
+        cells.emplace_back(img, i % 9, i / 9);
+    }
+
+    return cells;
+}
+
+void BM_PredictNumbersBatched(benchmark::State &state) {
+    std::vector<Cell> cells = make_cells(state.range(0));
+
+    for (auto _ : state) {
+        classifier.predict_numbers(cells);
+    }
+
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+void BM_PredictNumbersPerCell(benchmark::State &state) {
+    std::vector<Cell> cells = make_cells(state.range(0));
+
+    for (auto _ : state) {
+        classifier.predict_numbers_per_cell(cells);
+    }
+
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK(BM_PredictNumbersBatched)->RangeMultiplier(3)->Range(1, 81)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_PredictNumbersPerCell)->RangeMultiplier(3)->Range(1, 81)->Unit(benchmark::kMicrosecond);
+// full grids from several threads at once, scales with the interpreter pool
+BENCHMARK(BM_PredictNumbersBatched)->Arg(81)->ThreadRange(1, 8)->UseRealTime()->Unit(benchmark::kMicrosecond);
+
+// pipeline_bench.cpp
+void register_pipeline_benchmarks(NumberClassifier &classifier);
+
+int main(int argc, char **argv) {
+    benchmark::Initialize(&argc, argv);
+
+    if (!classifier.load_model(MODEL_PATH.c_str())) {
+        printf("Could not load model %s\n", MODEL_PATH.c_str());
+        return 1;
+    }
+
+    register_pipeline_benchmarks(classifier);
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    classifier.release_model();
+
+    return 0;
+}
@@ -0,0 +1,46 @@
+#include <benchmark/benchmark.h>
+
+#include <opencv2/imgcodecs.hpp>
+#include <opencv2/imgproc.hpp>
+#include <string>
+#include <vector>
+
+#include "detection/grid_detector.hpp"
+#include "detection/integral_threshold.hpp"
+
+const std::string IMAGE_PATH = std::string(CMAKE_IMAGES_PATH) + "/1.jpg";
+
+// block sizes and C of the detection cascade
+const auto &SETTINGS = GridDetector::threshold_settings();
+
+cv::Mat load_preprocessed() {
+    return GridDetector::preprocess(cv::imread(IMAGE_PATH, cv::IMREAD_GRAYSCALE));
+}
+
+void BM_CascadeAdaptiveThreshold(benchmark::State &state) {
+    cv::Mat preprocessed = load_preprocessed();
+    cv::Mat thresholded;
+
+    for (auto _ : state) {
+        for (const auto &[block_size, c] : SETTINGS) {
+            cv::adaptiveThreshold(preprocessed, thresholded, 255, cv::ADAPTIVE_THRESH_MEAN_C, cv::THRESH_BINARY_INV, block_size, c);
+            benchmark::DoNotOptimize(thresholded.data);
+        }
+    }
+}
+
+void BM_CascadeIntegralThreshold(benchmark::State &state) {
+    cv::Mat preprocessed = load_preprocessed();
+    cv::Mat thresholded;
+
+    for (auto _ : state) {
+        IntegralThreshold thresholder(preprocessed, std::get<0>(SETTINGS.front()));
+        for (const auto &[block_size, c] : SETTINGS) {
+            thresholder.apply(thresholded, block_size, c);
+            benchmark::DoNotOptimize(thresholded.data);
+        }
+    }
+}
+
+BENCHMARK(BM_CascadeAdaptiveThreshold)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_CascadeIntegralThreshold)->Unit(benchmark::kMicrosecond);
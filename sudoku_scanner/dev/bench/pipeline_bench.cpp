@@ -0,0 +1,198 @@
+// Every stage of the scan pipeline on every image in dev/images, registered
+// as <stage>/<image> (e.g. "ExtractCells/12.jpg"). Each stage gets the output
+// of the previous ones precomputed, so only the stage itself is timed. Use
+// --benchmark_out=<file> --benchmark_out_format=json (or csv) for output
+// that can be compared between runs.
+
+#include <benchmark/benchmark.h>
+
+#include <fstream>
+#include <iterator>
+#include <opencv2/core.hpp>
+#include <string>
+#include <vector>
+
+#include "decoding/image_decoder.hpp"
+#include "detection/grid_detector.hpp"
+#include "detection/integral_threshold.hpp"
+#include "extraction/classification/number_classifier.hpp"
+#include "extraction/grid_extractor.hpp"
+
+namespace {
+const std::string IMAGES_PATH(CMAKE_IMAGES_PATH);
+
+// one image with the intermediate results of every stage
+struct Sample {
+    std::string name;
+    std::vector<std::uint8_t> encoded;
+    cv::Mat gray;
+    cv::Mat preprocessed;
+    std::vector<cv::Point> corners;
+    cv::Mat warped;
+    cv::Mat thresholded;
+    cv::Mat binary;
+    std::vector<Cell> cells;
+};
+
+// referenced by the registered benchmarks, so it must not change after registration
+std::vector<Sample> samples;
+NumberClassifier *classifier = nullptr;
+// default tuning, sequential and in priority order
+CascadeState cascade;
+
+std::vector<std::uint8_t> read_file(const std::string &path) {
+    std::ifstream file(path, std::ios::binary);
+    return std::vector<std::uint8_t>(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+}
+
+void crop_and_transform(cv::Mat &img, const std::vector<cv::Point> &corners) {
+    GridExtractor::crop_and_transform(img, corners[0].x, corners[0].y, corners[1].x, corners[1].y, corners[2].x,
+                                      corners[2].y, corners[3].x, corners[3].y);
+}
+
+Sample load_sample(const std::string &path) {
+    Sample sample;
+    sample.name = path.substr(path.find_last_of('/') + 1);
+    sample.encoded = read_file(path);
+    sample.gray = ImageDecoder::decode(sample.encoded.data(), sample.encoded.size());
+
+    if (sample.gray.empty()) {
+        return sample;
+    }
+
+    sample.preprocessed = GridDetector::preprocess(sample.gray);
+    sample.corners = GridDetector::detect_grid(sample.preprocessed, sample.gray.size(), cascade);
+
+    sample.warped = sample.gray;
+    crop_and_transform(sample.warped, sample.corners);
+    GridExtractor::binarize(sample.warped, sample.thresholded);
+    sample.binary = sample.thresholded.clone();
+    GridExtractor::remove_grid_lines(sample.binary);
+    sample.cells = GridExtractor::extract_cells(sample.binary, sample.warped);
+
+    return sample;
+}
+
+void BM_Decode(benchmark::State &state, const Sample *sample) {
+    for (auto _ : state) {
+        cv::Mat decoded = ImageDecoder::decode(sample->encoded.data(), sample->encoded.size());
+        benchmark::DoNotOptimize(decoded.data);
+    }
+
+    state.SetBytesProcessed(state.iterations() * sample->encoded.size());
+}
+
+void BM_Preprocess(benchmark::State &state, const Sample *sample) {
+    for (auto _ : state) {
+        cv::Mat preprocessed = GridDetector::preprocess(sample->gray);
+        benchmark::DoNotOptimize(preprocessed.data);
+    }
+}
+
+void BM_DetectGrid(benchmark::State &state, const Sample *sample) {
+    for (auto _ : state) {
+        std::vector<cv::Point> corners = GridDetector::detect_grid(sample->preprocessed, sample->gray.size(), cascade);
+        benchmark::DoNotOptimize(corners.data());
+    }
+}
+
+// one cascade pass: thresholding plus the contour search
+void BM_ThresholdPass(benchmark::State &state, const Sample *sample, int setting) {
+    const auto &[block_size, c] = GridDetector::threshold_settings()[setting];
+    const IntegralThreshold thresholder(sample->preprocessed, block_size);
+    cv::Mat thresholded;
+    std::vector<cv::Point> corners;
+
+    for (auto _ : state) {
+        thresholder.apply(thresholded, block_size, c);
+        benchmark::DoNotOptimize(GridDetector::find_sudoku_grid(thresholded, corners));
+    }
+}
+
+void BM_CropAndTransform(benchmark::State &state, const Sample *sample) {
+    for (auto _ : state) {
+        cv::Mat img = sample->gray;
+        crop_and_transform(img, sample->corners);
+        benchmark::DoNotOptimize(img.data);
+    }
+}
+
+void BM_Binarize(benchmark::State &state, const Sample *sample) {
+    cv::Mat thresholded;
+
+    for (auto _ : state) {
+        GridExtractor::binarize(sample->warped, thresholded);
+        benchmark::DoNotOptimize(thresholded.data);
+    }
+}
+
+void BM_RemoveGridLines(benchmark::State &state, const Sample *sample) {
+    cv::Mat binary;
+
+    for (auto _ : state) {
+        // works in place, so every iteration needs a fresh copy
+        state.PauseTiming();
+        sample->thresholded.copyTo(binary);
+        state.ResumeTiming();
+
+        GridExtractor::remove_grid_lines(binary);
+        benchmark::DoNotOptimize(binary.data);
+    }
+}
+
+void BM_ExtractCells(benchmark::State &state, const Sample *sample) {
+    cv::Mat binary = sample->binary.clone();
+    cv::Mat warped = sample->warped.clone();
+
+    for (auto _ : state) {
+        std::vector<Cell> cells = GridExtractor::extract_cells(binary, warped);
+        benchmark::DoNotOptimize(cells.data());
+    }
+}
+
+void BM_PredictNumbers(benchmark::State &state, const Sample *sample) {
+    std::vector<Cell> cells = sample->cells;
+
+    for (auto _ : state) {
+        classifier->predict_numbers(cells);
+    }
+
+    state.SetItemsProcessed(state.iterations() * cells.size());
+}
+}  // namespace
+
+// called from main once the model is loaded, so the cells can be classified
+void register_pipeline_benchmarks(NumberClassifier &model_classifier) {
+    classifier = &model_classifier;
+
+    std::vector<cv::String> paths;
+    cv::glob(IMAGES_PATH + "/*.jpg", paths);
+
+    for (const cv::String &path : paths) {
+        samples.push_back(load_sample(path));
+    }
+
+    for (const Sample &sample : samples) {
+        if (sample.gray.empty()) {
+            continue;
+        }
+
+        const Sample *s = &sample;
+        const std::string &name = sample.name;
+
+        benchmark::RegisterBenchmark(("Decode/" + name).c_str(), BM_Decode, s)->Unit(benchmark::kMillisecond);
+        benchmark::RegisterBenchmark(("Preprocess/" + name).c_str(), BM_Preprocess, s)->Unit(benchmark::kMicrosecond);
+        benchmark::RegisterBenchmark(("DetectGrid/" + name).c_str(), BM_DetectGrid, s)->Unit(benchmark::kMicrosecond);
+
+        for (int setting = 0; setting < CascadeStatistics::SETTING_COUNT; ++setting) {
+            const std::string stage = "ThresholdPass/" + std::to_string(setting) + "/";
+            benchmark::RegisterBenchmark((stage + name).c_str(), BM_ThresholdPass, s, setting)->Unit(benchmark::kMicrosecond);
+        }
+
+        benchmark::RegisterBenchmark(("CropAndTransform/" + name).c_str(), BM_CropAndTransform, s)->Unit(benchmark::kMicrosecond);
+        benchmark::RegisterBenchmark(("Binarize/" + name).c_str(), BM_Binarize, s)->Unit(benchmark::kMicrosecond);
+        benchmark::RegisterBenchmark(("RemoveGridLines/" + name).c_str(), BM_RemoveGridLines, s)->Unit(benchmark::kMicrosecond);
+        benchmark::RegisterBenchmark(("ExtractCells/" + name).c_str(), BM_ExtractCells, s)->Unit(benchmark::kMicrosecond);
+        benchmark::RegisterBenchmark(("PredictNumbers/" + name).c_str(), BM_PredictNumbers, s)->Unit(benchmark::kMicrosecond);
+    }
+}
@@ -0,0 +1,512 @@
+// Scans every image of a manifest (see scan_manifest.txt) in parallel and
+// reports digit accuracy, detection IoU (for images with ground truth
+// corners) and p50/p95/p99 latency per pipeline stage. --save writes the
+// results as "<key> <value>" lines, --baseline compares against such a file
+// and exits with 1 on regressions. Latency with more than one thread includes
+// contention, use -j 1 for clean numbers. --backend pins the inference
+// backend instead of benchmarking them at startup.
+//
+// usage: sudoku_scanner_harness [-j threads] [--save file] [--baseline file]
+//                               [--tolerance fraction] [--backend name] [manifest]
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <opencv2/imgproc.hpp>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "profiling/scan_profiler.hpp"
+#include "sudoku_scanner.h"
+
+namespace {
+const std::string MODEL_PATH = std::string(CMAKE_ASSETS_PATH) + "/model.tflite";
+const std::string DEFAULT_MANIFEST = std::string(CMAKE_BENCH_PATH) + "/scan_manifest.txt";
+
+// same order as ScanStage, plus the wall time of the whole scan
+const char *const STAGE_NAMES[] = {"decode", "preprocess", "locate_grid", "warp", "binarize",
+                                   "remove_grid_lines", "extract_cells", "predict_numbers", "correct_numbers", "total"};
+const int STAGE_COUNT = ScanRecord::STAGE_COUNT + 1;
+const int TOTAL = ScanRecord::STAGE_COUNT;
+
+// allowed drop of IoU before it counts as regression
+const double IOU_TOLERANCE = 0.01;
+
+using Clock = std::chrono::steady_clock;
+
+struct Entry {
+    std::string name;
+    std::string path;
+    std::uint8_t expected[81];
+    bool has_corners = false;
+    // top left, top right, bottom left, bottom right
+    cv::Point2f corners[4];
+};
+
+struct Result {
+    bool scanned = false;
+    int wrong = 0;    // digit read as another digit
+    int missed = 0;   // digit read as blank
+    int phantom = 0;  // blank read as digit
+    double iou = 0.0;
+    double stage_microseconds[STAGE_COUNT] = {};
+
+    int errors() const {
+        return wrong + missed + phantom;
+    }
+};
+
+bool file_exists(const std::string &path) {
+    return std::ifstream(path).good();
+}
+
+bool parse_entry(const std::string &line, const std::string &directory, Entry &entry) {
+    std::istringstream stream(line);
+    std::string image, digits;
+
+    if (!(stream >> image >> digits) || digits.size() != 81) {
+        return false;
+    }
+
+    entry.name = image.substr(image.find_last_of('/') + 1);
+    entry.path = image[0] == '/' ? image : directory + "/" + image;
+
+    for (int i = 0; i < 81; ++i) {
+        if (digits[i] == '.') {
+            entry.expected[i] = 0;
+        } else if (digits[i] >= '0' && digits[i] <= '9') {
+            entry.expected[i] = digits[i] - '0';
+        } else {
+            return false;
+        }
+    }
+
+    float values[8];
+    int count = 0;
+    while (count < 8 && stream >> values[count]) ++count;
+
+    if (count == 8) {
+        entry.has_corners = true;
+        for (int i = 0; i < 4; ++i) entry.corners[i] = cv::Point2f(values[2 * i], values[2 * i + 1]);
+    } else if (count != 0) {
+        return false;
+    }
+
+    return true;
+}
+
+std::vector<Entry> read_manifest(const std::string &path) {
+    std::ifstream file(path);
+    if (!file) {
+        std::fprintf(stderr, "cannot open %s\n", path.c_str());
+        std::exit(1);
+    }
+
+    const std::size_t slash = path.find_last_of('/');
+    const std::string directory = slash == std::string::npos ? "." : path.substr(0, slash);
+
+    std::vector<Entry> entries;
+    std::string line;
+    int number = 0;
+
+    while (std::getline(file, line)) {
+        ++number;
+        if (line.empty() || line[0] == '#') continue;
+
+        Entry entry;
+        if (!parse_entry(line, directory, entry)) {
+            std::fprintf(stderr, "%s:%d: malformed entry\n", path.c_str(), number);
+            std::exit(1);
+        }
+        entries.push_back(entry);
+    }
+
+    return entries;
+}
+
+// corners in contour order, relative coordinates keep the area ratios
+std::vector<cv::Point2f> to_polygon(const cv::Point2f *corners) {
+    return {corners[0], corners[1], corners[3], corners[2]};
+}
+
+double intersection_over_union(const cv::Point2f *detected, const cv::Point2f *expected) {
+    std::vector<cv::Point2f> a = to_polygon(detected);
+    std::vector<cv::Point2f> b = to_polygon(expected);
+    std::vector<cv::Point2f> intersection;
+
+    // a broken detection might not be convex
+    if (!cv::isContourConvex(a)) return 0.0;
+
+    const double overlap = cv::intersectConvexConvex(a, b, intersection, true);
+    const double combined = cv::contourArea(a) + cv::contourArea(b) - overlap;
+
+    return combined > 0.0 ? overlap / combined : 0.0;
+}
+
+void add_stages(const ScanRecord &record, Result &result) {
+    for (int i = 0; i < ScanRecord::STAGE_COUNT; ++i) {
+        result.stage_microseconds[i] += record.stage_nanoseconds[i] / 1000.0;
+    }
+}
+
+Result scan(ScannerContext *context, const Entry &entry) {
+    Result result;
+
+    if (!file_exists(entry.path)) {
+        return result;
+    }
+
+    const auto start = Clock::now();
+
+    std::unique_ptr<BoundingBox> bounding_box(detect_grid(context, entry.path.c_str()));
+    add_stages(ScanProfiler::last_trace(), result);
+
+    std::unique_ptr<std::uint8_t[]> grid(extract_grid(context, entry.path.c_str(), bounding_box.get()));
+    add_stages(ScanProfiler::last_trace(), result);
+
+    result.stage_microseconds[TOTAL] = std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+    result.scanned = true;
+
+    for (int i = 0; i < 81; ++i) {
+        const std::uint8_t expected = entry.expected[i];
+        const std::uint8_t actual = grid[i];
+
+        if (actual == expected) continue;
+
+        if (expected == 0) {
+            ++result.phantom;
+        } else if (actual == 0) {
+            ++result.missed;
+        } else {
+            ++result.wrong;
+        }
+    }
+
+    if (entry.has_corners) {
+        const cv::Point2f detected[4] = {
+            cv::Point2f(bounding_box->top_left.x, bounding_box->top_left.y),
+            cv::Point2f(bounding_box->top_right.x, bounding_box->top_right.y),
+            cv::Point2f(bounding_box->bottom_left.x, bounding_box->bottom_left.y),
+            cv::Point2f(bounding_box->bottom_right.x, bounding_box->bottom_right.y)};
+        result.iou = intersection_over_union(detected, entry.corners);
+    }
+
+    return result;
+}
+
+std::vector<Result> scan_all(ScannerContext *context, const std::vector<Entry> &entries, int threads) {
+    std::vector<Result> results(entries.size());
+    std::atomic<std::size_t> next{0};
+    std::vector<std::thread> pool;
+
+    for (int i = 0; i < threads; ++i) {
+        pool.emplace_back([&]() {
+            for (std::size_t index; (index = next.fetch_add(1)) < entries.size();) {
+                results[index] = scan(context, entries[index]);
+            }
+        });
+    }
+
+    for (auto &thread : pool) thread.join();
+
+    return results;
+}
+
+double percentile(const std::vector<double> &sorted, double p) {
+    if (sorted.empty()) return 0.0;
+    return sorted[std::min(sorted.size() - 1, static_cast<std::size_t>(p * sorted.size()))];
+}
+
+std::string format_double(double value) {
+    char buffer[32];
+    std::snprintf(buffer, sizeof(buffer), "%.6g", value);
+    return buffer;
+}
+
+// everything a run reports, keyed like the saved results file
+std::map<std::string, double> summarize(const std::vector<Entry> &entries, const std::vector<Result> &results) {
+    std::map<std::string, double> metrics;
+    int scanned = 0, correct_grids = 0, cells = 0, errors = 0, wrong = 0, missed = 0, phantom = 0, with_corners = 0;
+    double iou_sum = 0.0, iou_min = 1.0;
+    std::vector<double> latencies[STAGE_COUNT];
+
+    for (std::size_t i = 0; i < entries.size(); ++i) {
+        const Result &result = results[i];
+        if (!result.scanned) continue;
+
+        ++scanned;
+        cells += 81;
+        errors += result.errors();
+        wrong += result.wrong;
+        missed += result.missed;
+        phantom += result.phantom;
+        if (result.errors() == 0) ++correct_grids;
+
+        metrics["image." + entries[i].name + ".errors"] = result.errors();
+
+        if (entries[i].has_corners) {
+            ++with_corners;
+            iou_sum += result.iou;
+            iou_min = std::min(iou_min, result.iou);
+            metrics["image." + entries[i].name + ".iou"] = result.iou;
+        }
+
+        for (int stage = 0; stage < STAGE_COUNT; ++stage) {
+            latencies[stage].push_back(result.stage_microseconds[stage]);
+        }
+    }
+
+    metrics["images"] = scanned;
+    // manifest entries that could not be read, every one is a regression
+    metrics["missing_images"] = entries.size() - scanned;
+    metrics["digit_accuracy"] = cells ? 1.0 - static_cast<double>(errors) / cells : 0.0;
+    metrics["grid_accuracy"] = scanned ? static_cast<double>(correct_grids) / scanned : 0.0;
+    metrics["wrong_digits"] = wrong;
+    metrics["missed_digits"] = missed;
+    metrics["phantom_digits"] = phantom;
+
+    if (with_corners) {
+        metrics["iou_mean"] = iou_sum / with_corners;
+        metrics["iou_min"] = iou_min;
+    }
+
+    for (int stage = 0; stage < STAGE_COUNT; ++stage) {
+        std::sort(latencies[stage].begin(), latencies[stage].end());
+        const std::string key = std::string("latency.") + STAGE_NAMES[stage];
+        metrics[key + ".p50_us"] = percentile(latencies[stage], 0.5);
+        metrics[key + ".p95_us"] = percentile(latencies[stage], 0.95);
+        metrics[key + ".p99_us"] = percentile(latencies[stage], 0.99);
+    }
+
+    return metrics;
+}
+
+void print_report(const std::vector<Entry> &entries, const std::vector<Result> &results, std::map<std::string, double> &metrics) {
+    const int images = metrics["images"];
+
+    std::printf("digit accuracy %7.2f%% (%.0f wrong, %.0f missed, %.0f phantom in %d cells)\n",
+                100.0 * metrics["digit_accuracy"], metrics["wrong_digits"], metrics["missed_digits"],
+                metrics["phantom_digits"], images * 81);
+    std::printf("grid accuracy  %7.2f%% (%d images)\n", 100.0 * metrics["grid_accuracy"], images);
+
+    if (metrics.count("iou_mean")) {
+        std::printf("detection IoU   mean %.3f, min %.3f\n", metrics["iou_mean"], metrics["iou_min"]);
+    }
+
+    std::printf("\n%-18s %10s %10s %10s\n", "stage", "p50 us", "p95 us", "p99 us");
+    for (const char *name : STAGE_NAMES) {
+        const std::string key = std::string("latency.") + name;
+        std::printf("%-18s %10.0f %10.0f %10.0f\n", name, metrics[key + ".p50_us"], metrics[key + ".p95_us"],
+                    metrics[key + ".p99_us"]);
+    }
+
+    bool header = false;
+    for (std::size_t i = 0; i < entries.size(); ++i) {
+        const Result &result = results[i];
+        if (result.scanned && result.errors() == 0) continue;
+
+        if (!header) {
+            std::printf("\nimages with errors\n");
+            header = true;
+        }
+
+        if (!result.scanned) {
+            std::printf("  %s: missing\n", entries[i].path.c_str());
+        } else {
+            std::printf("  %s: %d wrong, %d missed, %d phantom\n", entries[i].name.c_str(), result.wrong,
+                        result.missed, result.phantom);
+        }
+    }
+}
+
+void save(const std::string &path, const std::map<std::string, double> &metrics) {
+    std::ofstream file(path);
+    for (const auto &[key, value] : metrics) {
+        file << key << ' ' << format_double(value) << '\n';
+    }
+}
+
+std::map<std::string, double> load(const std::string &path) {
+    std::ifstream file(path);
+    if (!file) {
+        std::fprintf(stderr, "cannot open %s\n", path.c_str());
+        std::exit(1);
+    }
+
+    std::map<std::string, double> metrics;
+    std::string key;
+    double value;
+    while (file >> key >> value) metrics[key] = value;
+
+    return metrics;
+}
+
+bool starts_with(const std::string &text, const std::string &prefix) {
+    return text.compare(0, prefix.size(), prefix) == 0;
+}
+
+bool ends_with(const std::string &text, const std::string &suffix) {
+    return text.size() >= suffix.size() && text.compare(text.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+// Prints every changed metric, returns false if any of them regressed. Images
+// that could not be scanned always count as a regression.
+bool compare(const std::map<std::string, double> &baseline, const std::map<std::string, double> &current, double tolerance) {
+    bool passed = true;
+
+    for (const auto &[key, before] : baseline) {
+        const auto it = current.find(key);
+
+        // a per image result that is gone means the image was not scanned
+        if (it == current.end()) {
+            if (starts_with(key, "image.")) {
+                std::printf("  %-40s %12s -> %-12s REGRESSION\n", key.c_str(), format_double(before).c_str(), "missing");
+                passed = false;
+            }
+            continue;
+        }
+
+        const double after = it->second;
+        bool regressed = false;
+
+        if (key == "images") {
+            // fewer images would make the accuracies look unchanged or better
+            regressed = after < before;
+        } else if (key == "missing_images") {
+            regressed = after > 0;
+        } else if (key == "digit_accuracy" || key == "grid_accuracy") {
+            regressed = after < before;
+        } else if (ends_with(key, ".errors")) {
+            regressed = after > before;
+        } else if (key == "iou_mean" || key == "iou_min" || ends_with(key, ".iou")) {
+            regressed = after < before - IOU_TOLERANCE;
+        } else if (ends_with(key, ".p95_us")) {
+            // p50 follows p95 and p99 is too noisy for small manifests
+            regressed = after > before * (1.0 + tolerance);
+        }
+
+        // latency always jitters, so it only shows up when it regressed
+        if (!regressed && (after == before || ends_with(key, "_us"))) continue;
+
+        std::printf("  %-40s %12s -> %-12s%s\n", key.c_str(), format_double(before).c_str(),
+                    format_double(after).c_str(), regressed ? " REGRESSION" : "");
+        passed = passed && !regressed;
+    }
+
+    // baselines from before missing_images was recorded
+    const auto missing = current.find("missing_images");
+    if (missing != current.end() && missing->second > 0 && !baseline.count("missing_images")) {
+        std::printf("  %-40s %12s -> %-12s REGRESSION\n", "missing_images", "-", format_double(missing->second).c_str());
+        passed = false;
+    }
+
+    return passed;
+}
+
+// indexed by BACKEND_* id
+const char *const BACKEND_NAMES[BACKEND_COUNT] = {"cpu", "xnnpack", "nnapi"};
+
+// BACKEND_AUTO for "auto", BACKEND_COUNT for unknown names
+int parse_backend(const char *name) {
+    if (!std::strcmp(name, "auto")) return BACKEND_AUTO;
+
+    for (int i = 0; i < BACKEND_COUNT; ++i) {
+        if (!std::strcmp(name, BACKEND_NAMES[i])) return i;
+    }
+
+    return BACKEND_COUNT;
+}
+
+void print_backend(ScannerContext *context) {
+    BackendInfo info;
+    get_backend_info(context, &info);
+
+    std::printf("backend %s, %d thread(s) per interpreter", BACKEND_NAMES[info.backend], info.threads);
+
+    if (info.cached) {
+        std::printf(" (cached)");
+    }
+
+    for (int i = 0; i < BACKEND_COUNT; ++i) {
+        if (info.benchmark_us[i] > 0) {
+            std::printf(", %s %u us", BACKEND_NAMES[i], info.benchmark_us[i]);
+        }
+    }
+
+    std::printf("\n");
+}
+}  // namespace
+
+int main(int argc, char **argv) {
+    int threads = std::max(1u, std::thread::hardware_concurrency());
+    double tolerance = 0.2;
+    std::string manifest = DEFAULT_MANIFEST;
+    std::string save_path, baseline_path;
+    int backend = BACKEND_AUTO;
+
+    for (int i = 1; i < argc; ++i) {
+        const bool has_value = i + 1 < argc;
+
+        if (!std::strcmp(argv[i], "-j") && has_value) {
+            threads = std::max(1, std::atoi(argv[++i]));
+        } else if (!std::strcmp(argv[i], "--save") && has_value) {
+            save_path = argv[++i];
+        } else if (!std::strcmp(argv[i], "--baseline") && has_value) {
+            baseline_path = argv[++i];
+        } else if (!std::strcmp(argv[i], "--tolerance") && has_value) {
+            tolerance = std::atof(argv[++i]);
+        } else if (!std::strcmp(argv[i], "--backend") && has_value && parse_backend(argv[i + 1]) != BACKEND_COUNT) {
+            backend = parse_backend(argv[++i]);
+        } else if (argv[i][0] != '-') {
+            manifest = argv[i];
+        } else {
+            std::fprintf(stderr, "usage: %s [-j threads] [--save file] [--baseline file] [--tolerance fraction] "
+                         "[--backend auto|cpu|xnnpack|nnapi] [manifest]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    if (!ScanProfiler::is_enabled()) {
+        std::fprintf(stderr, "built without SCAN_STATS, stage latencies will be 0\n");
+    }
+
+    const std::vector<Entry> entries = read_manifest(manifest);
+    ScannerContext *context = scanner_create(MODEL_PATH.c_str(), backend);
+
+    if (!context) {
+        std::fprintf(stderr, "cannot load model %s\n", MODEL_PATH.c_str());
+        return 1;
+    }
+
+    std::printf("%zu images from %s, %d thread(s)\n", entries.size(), manifest.c_str(), threads);
+    print_backend(context);
+    std::printf("\n");
+
+    const std::vector<Result> results = scan_all(context, entries, threads);
+    scanner_destroy(context);
+    std::map<std::string, double> metrics = summarize(entries, results);
+
+    print_report(entries, results, metrics);
+
+    if (!save_path.empty()) {
+        save(save_path, metrics);
+    }
+
+    if (!baseline_path.empty()) {
+        std::printf("\ncompared with %s\n", baseline_path.c_str());
+        if (!compare(load(baseline_path), metrics, tolerance)) {
+            return 1;
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,285 @@
+// Solves every puzzle of a file with 1, 2, 4, ... threads and reports
+// throughput, per puzzle latency percentiles and scaling. Each line of the
+// file starts with the 81 cells of a puzzle in row-major order, digits with
+// 0 or '.' for empty cells. Other lines (e.g. headers) are skipped.
+//
+// usage: sudoku_solver_throughput <puzzle file> [max threads]
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "solving/sudoku_solver.hpp"
+
+namespace {
+// puzzles a worker takes from its own shard at once
+const std::size_t CHUNK_SIZE = 64;
+
+using Clock = std::chrono::steady_clock;
+
+class MappedFile {
+   public:
+    explicit MappedFile(const char *path) {
+        const int fd = open(path, O_RDONLY);
+        if (fd < 0) throw std::runtime_error(std::string("cannot open ") + path);
+
+        struct stat status;
+        if (fstat(fd, &status) < 0) {
+            close(fd);
+            throw std::runtime_error(std::string("cannot stat ") + path);
+        }
+
+        size = status.st_size;
+        if (size > 0) {
+            void *mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+            close(fd);
+            if (mapping == MAP_FAILED) throw std::runtime_error(std::string("cannot map ") + path);
+
+            data = static_cast<const char *>(mapping);
+            madvise(mapping, size, MADV_SEQUENTIAL);
+        } else {
+            close(fd);
+        }
+    }
+
+    ~MappedFile() {
+        if (data) munmap(const_cast<char *>(data), size);
+    }
+
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    const char *data = nullptr;
+    std::size_t size = 0;
+};
+
+bool is_cell(char c) {
+    return c == '.' || (c >= '0' && c <= '9');
+}
+
+// start of every line that holds a puzzle
+std::vector<const char *> index_puzzles(const MappedFile &file) {
+    std::vector<const char *> puzzles;
+    const char *end = file.data + file.size;
+
+    for (const char *line = file.data; line < end;) {
+        const char *line_end = std::find(line, end, '\n');
+
+        if (line_end - line >= 81 && std::all_of(line, line + 81, is_cell)) {
+            puzzles.push_back(line);
+        }
+
+        line = line_end + (line_end < end ? 1 : 0);
+    }
+
+    return puzzles;
+}
+
+void parse_puzzle(const char *line, std::uint8_t *grid) {
+    for (int i = 0; i < 81; ++i) {
+        grid[i] = line[i] == '.' ? 0 : line[i] - '0';
+    }
+}
+
+// Every worker starts with an even share of the puzzles and works through
+// it in chunks from the front. A worker without work steals the back half of
+// another worker's remaining range, so slow shards (hard puzzles) get split.
+class WorkQueue {
+   public:
+    WorkQueue(std::size_t count, int workers) : shards(workers) {
+        for (int i = 0; i < workers; ++i) {
+            shards[i].begin = count * i / workers;
+            shards[i].end = count * (i + 1) / workers;
+        }
+    }
+
+    // next range of puzzle indices for worker, false once all work is taken
+    bool next(int worker, std::size_t &begin, std::size_t &end, std::size_t &steals) {
+        while (true) {
+            if (take(shards[worker], begin, end)) return true;
+            if (!steal(worker)) return false;
+            ++steals;
+        }
+    }
+
+   private:
+    struct Shard {
+        std::mutex mutex;
+        std::size_t begin = 0;
+        std::size_t end = 0;
+    };
+
+    std::vector<Shard> shards;
+
+    static bool take(Shard &shard, std::size_t &begin, std::size_t &end) {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        if (shard.begin == shard.end) return false;
+
+        begin = shard.begin;
+        end = std::min(shard.begin + CHUNK_SIZE, shard.end);
+        shard.begin = end;
+        return true;
+    }
+
+    // moves the back half of the next non-empty shard to the worker's own shard
+    bool steal(int worker) {
+        const int count = shards.size();
+
+        for (int i = 1; i < count; ++i) {
+            Shard &victim = shards[(worker + i) % count];
+            std::size_t begin, end;
+            {
+                std::lock_guard<std::mutex> lock(victim.mutex);
+                const std::size_t remaining = victim.end - victim.begin;
+                if (remaining == 0) continue;
+
+                end = victim.end;
+                begin = end - (remaining + 1) / 2;
+                victim.end = begin;
+            }
+
+            std::lock_guard<std::mutex> lock(shards[worker].mutex);
+            shards[worker].begin = begin;
+            shards[worker].end = end;
+            return true;
+        }
+
+        return false;
+    }
+};
+
+struct WorkerResult {
+    std::vector<float> latencies;  // microseconds
+    std::size_t unsolved = 0;
+    std::size_t steals = 0;
+};
+
+struct RunResult {
+    int threads;
+    double seconds;
+    std::vector<WorkerResult> workers;
+};
+
+RunResult run(const std::vector<const char *> &puzzles, int threads) {
+    WorkQueue queue(puzzles.size(), threads);
+    RunResult result{threads, 0.0, std::vector<WorkerResult>(threads)};
+
+    std::atomic<bool> start{false};
+    std::vector<std::thread> pool;
+
+    for (int worker = 0; worker < threads; ++worker) {
+        pool.emplace_back([&, worker]() {
+            WorkerResult &own = result.workers[worker];
+            own.latencies.reserve(puzzles.size() / threads + CHUNK_SIZE);
+
+            std::uint8_t grid[81];
+            std::uint8_t solution[81];
+            std::size_t begin, end;
+
+            while (!start.load(std::memory_order_acquire)) std::this_thread::yield();
+
+            while (queue.next(worker, begin, end, own.steals)) {
+                for (std::size_t i = begin; i < end; ++i) {
+                    const auto puzzle_start = Clock::now();
+
+                    parse_puzzle(puzzles[i], grid);
+                    if (!SudokuSolver::solve(grid, solution)) ++own.unsolved;
+
+                    own.latencies.push_back(std::chrono::duration<float, std::micro>(Clock::now() - puzzle_start).count());
+                }
+            }
+        });
+    }
+
+    const auto run_start = Clock::now();
+    start.store(true, std::memory_order_release);
+    for (auto &thread : pool) thread.join();
+    result.seconds = std::chrono::duration<double>(Clock::now() - run_start).count();
+
+    return result;
+}
+
+float percentile(const std::vector<float> &sorted, double p) {
+    if (sorted.empty()) return 0.0f;
+    return sorted[std::min(sorted.size() - 1, static_cast<std::size_t>(p * sorted.size()))];
+}
+}  // namespace
+
+int main(int argc, char **argv) {
+    if (argc < 2) {
+        std::fprintf(stderr, "usage: %s <puzzle file> [max threads]\n", argv[0]);
+        return 1;
+    }
+
+    const int max_threads = argc > 2 ? std::atoi(argv[2]) : std::max(1u, std::thread::hardware_concurrency());
+    if (max_threads < 1) {
+        std::fprintf(stderr, "max threads must be positive\n");
+        return 1;
+    }
+
+    MappedFile file(argv[1]);
+    const std::vector<const char *> puzzles = index_puzzles(file);
+
+    if (puzzles.empty()) {
+        std::fprintf(stderr, "no puzzles in %s\n", argv[1]);
+        return 1;
+    }
+
+    std::vector<int> thread_counts;
+    for (int threads = 1; threads < max_threads; threads *= 2) thread_counts.push_back(threads);
+    thread_counts.push_back(max_threads);
+
+    std::printf("%zu puzzles from %s\n\n", puzzles.size(), argv[1]);
+    std::printf("%7s %12s %8s %10s %9s %9s %9s %9s %9s %7s %8s\n", "threads", "puzzles/s", "speedup", "efficiency", "p50 us",
+                "p90 us", "p99 us", "p99.9 us", "max us", "steals", "unsolved");
+
+    double single_rate = 0.0;
+    RunResult last;
+
+    for (const int threads : thread_counts) {
+        RunResult result = run(puzzles, threads);
+
+        std::vector<float> latencies;
+        latencies.reserve(puzzles.size());
+        std::size_t steals = 0;
+        std::size_t unsolved = 0;
+
+        for (const auto &worker : result.workers) {
+            latencies.insert(latencies.end(), worker.latencies.begin(), worker.latencies.end());
+            steals += worker.steals;
+            unsolved += worker.unsolved;
+        }
+        std::sort(latencies.begin(), latencies.end());
+
+        const double rate = puzzles.size() / result.seconds;
+        if (threads == 1) single_rate = rate;
+        const double speedup = rate / single_rate;
+
+        std::printf("%7d %12.0f %8.2f %9.0f%% %9.1f %9.1f %9.1f %9.1f %9.1f %7zu %8zu\n", threads, rate, speedup,
+                    100.0 * speedup / threads, percentile(latencies, 0.5), percentile(latencies, 0.9),
+                    percentile(latencies, 0.99), percentile(latencies, 0.999), latencies.back(), steals, unsolved);
+
+        last = std::move(result);
+    }
+
+    // how evenly work stealing spread the puzzles in the widest run
+    std::printf("\n%7s %12s %7s\n", "worker", "puzzles", "steals");
+    for (int i = 0; i < last.threads; ++i) {
+        std::printf("%7d %12zu %7zu\n", i, last.workers[i].latencies.size(), last.workers[i].steals);
+    }
+
+    return 0;
+}
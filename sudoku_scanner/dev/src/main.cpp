@@ -8,8 +8,6 @@
 #include <opencv2/imgproc.hpp>
 
 #include "detection/grid_detector.hpp"
-#include "extraction/grid_extractor.hpp"
-#include "extraction/structs/grid.hpp"
 #include "sudoku_scanner.h"
 
 const std::string IMAGE_PATH = std::string(CMAKE_IMAGES_PATH) + "/26.jpg";
@@ -75,25 +73,23 @@ int main() {
     }
 
     // init tflite model
-    set_model(MODEL_PATH.c_str());
+    ScannerContext *context = scanner_create(MODEL_PATH.c_str(), BACKEND_AUTO);
+
+    if (!context) {
+        printf("Could not load model %s\n", MODEL_PATH.c_str());
+        return 1;
+    }
 
     // bounding box
-    std::unique_ptr<BoundingBox> bb(detect_grid(IMAGE_PATH.c_str()));
+    std::unique_ptr<BoundingBox> bb(detect_grid(context, IMAGE_PATH.c_str()));
     printf("%f %f\n", bb->bottom_left.x, bb->bottom_left.y);
 
-    Grid grid = GridExtractor::extract_grid(
-        image,
-        bb->top_left.x * image.size().width,
-        bb->top_left.y * image.size().height,
-        bb->top_right.x * image.size().width,
-        bb->top_right.y * image.size().height,
-        bb->bottom_left.x * image.size().width,
-        bb->bottom_left.y * image.size().height,
-        bb->bottom_right.x * image.size().width,
-        bb->bottom_right.y * image.size().height);
+    // classified by the context, so the model is only loaded once
+    std::uint8_t *grid = extract_grid(context, IMAGE_PATH.c_str(), bb.get());
 
     // makes copy
-    std::vector<std::uint8_t> grid_vec(grid.data.get(), grid.data.get() + grid.size);
+    std::vector<std::uint8_t> grid_vec(grid, grid + 81);
+    free_pointer(grid);
     print_sudoku_grid(grid_vec);
 
     cv::waitKey(0);
@@ -104,5 +100,7 @@ int main() {
 
     // cv::waitKey(0);
 
+    scanner_destroy(context);
+
     return 0;
 }
@@ -2,10 +2,17 @@
 
 #include <algorithm>
 #include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
 #include <memory>
+#include <numeric>
 #include <string>
+#include <thread>
 #include <vector>
 
+#include "solving/grid_corrector.hpp"
+
 namespace ss {
 #include "sudoku_scanner.h"
 }
@@ -14,6 +21,9 @@ namespace ss {
 const std::string MODEL_PATH = std::string(CMAKE_ASSETS_PATH) + "/model.tflite";
 const std::string IMAGES_PATH(CMAKE_IMAGES_PATH);
 
+// created in main, shared by all tests
+ss::ScannerContext *context = nullptr;
+
 int get_diff_count(std::vector<std::uint8_t> &first, std::vector<std::uint8_t> &second) {
     std::vector<std::uint8_t> diff;
 
@@ -23,8 +33,8 @@ int get_diff_count(std::vector<std::uint8_t> &first, std::vector<std::uint8_t> &
 }
 
 void test_on_image(std::string &image_path, std::vector<std::uint8_t> &expected_grid) {
-    std::unique_ptr<ss::BoundingBox> bb(ss::detect_grid(image_path.c_str()));
-    std::unique_ptr<std::uint8_t> grid_ptr(ss::extract_grid(image_path.c_str(), bb.get()));
+    std::unique_ptr<ss::BoundingBox> bb(ss::detect_grid(context, image_path.c_str()));
+    std::unique_ptr<std::uint8_t> grid_ptr(ss::extract_grid(context, image_path.c_str(), bb.get()));
     std::vector<std::uint8_t> grid(grid_ptr.get(), grid_ptr.get() + 81);
     bb.release();
     grid_ptr.release();
@@ -510,8 +520,417 @@ TEST(IntegrationTest, TestTwentyeighthImage) {
     test_on_image(image_path, expected_grid);
 }
 
+TEST(IntegrationTest, TestGridDetails) {
+    std::string image_path = IMAGES_PATH + "/13.jpg";
+
+    std::unique_ptr<ss::BoundingBox> bb(ss::detect_grid(context, image_path.c_str()));
+    std::unique_ptr<std::uint8_t> grid_ptr(ss::extract_grid(context, image_path.c_str(), bb.get()));
+    ss::GridResult result;
+
+    ASSERT_TRUE(ss::extract_grid_details(context, image_path.c_str(), bb.get(), &result));
+
+    for (int i = 0; i < 81; ++i) {
+        const ss::CellResult &cell = result.cells[i];
+        EXPECT_EQ(cell.digit, grid_ptr.get()[i]) << "at cell " << i;
+
+        if (cell.digit == 0) {
+            EXPECT_EQ(cell.width, 0);
+            continue;
+        }
+
+        // digit lies inside its cell
+        const int cell_size = WARPED_GRID_SIZE / 9;
+        EXPECT_GE(cell.x, (i % 9) * cell_size - cell_size / 2);
+        EXPECT_LE(cell.x + cell.width, (i % 9 + 1) * cell_size + cell_size / 2);
+        EXPECT_GE(cell.y, (i / 9) * cell_size - cell_size / 2);
+        EXPECT_LE(cell.y + cell.height, (i / 9 + 1) * cell_size + cell_size / 2);
+        EXPECT_NEAR(std::accumulate(cell.probabilities, cell.probabilities + 9, 0.0f), 1.0f, 1e-3f);
+        EXPECT_LT(cell.blank_confidence, 0.5f);
+    }
+
+    bb.release();
+    grid_ptr.release();
+}
+
+bool is_valid_solution(const std::vector<std::uint8_t> &grid, const std::vector<std::uint8_t> &solution) {
+    for (int i = 0; i < 81; ++i) {
+        if (solution[i] < 1 || solution[i] > 9) return false;
+        if (grid[i] != 0 && grid[i] != solution[i]) return false;
+    }
+
+    for (int unit = 0; unit < 9; ++unit) {
+        int row = 0, col = 0, box = 0;
+        for (int i = 0; i < 9; ++i) {
+            row |= 1 << solution[unit * 9 + i];
+            col |= 1 << solution[i * 9 + unit];
+            box |= 1 << solution[(unit / 3) * 27 + (unit % 3) * 3 + (i / 3) * 9 + i % 3];
+        }
+        if (row != 0x3FE || col != 0x3FE || box != 0x3FE) return false;
+    }
+
+    return true;
+}
+
+TEST(SolverTest, TestEasyGrid) {
+    std::vector<std::uint8_t> grid{
+        5, 3, 0, 0, 7, 0, 0, 0, 0,
+        6, 0, 0, 1, 9, 5, 0, 0, 0,
+        0, 9, 8, 0, 0, 0, 0, 6, 0,
+        8, 0, 0, 0, 6, 0, 0, 0, 3,
+        4, 0, 0, 8, 0, 3, 0, 0, 1,
+        7, 0, 0, 0, 2, 0, 0, 0, 6,
+        0, 6, 0, 0, 0, 0, 2, 8, 0,
+        0, 0, 0, 4, 1, 9, 0, 0, 5,
+        0, 0, 0, 0, 8, 0, 0, 7, 9};
+
+    std::vector<std::uint8_t> solution(81);
+
+    ASSERT_TRUE(ss::solve_grid(grid.data(), solution.data()));
+    EXPECT_TRUE(is_valid_solution(grid, solution));
+}
+
+TEST(SolverTest, TestHardGrid) {
+    std::vector<std::uint8_t> grid{
+        8, 0, 0, 0, 0, 0, 0, 0, 0,
+        0, 0, 3, 6, 0, 0, 0, 0, 0,
+        0, 7, 0, 0, 9, 0, 2, 0, 0,
+        0, 5, 0, 0, 0, 7, 0, 0, 0,
+        0, 0, 0, 0, 4, 5, 7, 0, 0,
+        0, 0, 0, 1, 0, 0, 0, 3, 0,
+        0, 0, 1, 0, 0, 0, 0, 6, 8,
+        0, 0, 8, 5, 0, 0, 0, 1, 0,
+        0, 9, 0, 0, 0, 0, 4, 0, 0};
+
+    std::vector<std::uint8_t> solution(81);
+
+    ASSERT_TRUE(ss::solve_grid(grid.data(), solution.data()));
+    EXPECT_TRUE(is_valid_solution(grid, solution));
+}
+
+TEST(SolverTest, TestInvalidGrid) {
+    std::vector<std::uint8_t> grid(81, 0);
+    // same digit twice in the first row
+    grid[0] = 1;
+    grid[8] = 1;
+
+    std::vector<std::uint8_t> solution(81, 0);
+
+    EXPECT_FALSE(ss::solve_grid(grid.data(), solution.data()));
+    EXPECT_EQ(solution, std::vector<std::uint8_t>(81, 0));
+}
+
+TEST(SolverTest, TestSolutionCount) {
+    std::vector<std::uint8_t> grid{
+        5, 3, 0, 0, 7, 0, 0, 0, 0,
+        6, 0, 0, 1, 9, 5, 0, 0, 0,
+        0, 9, 8, 0, 0, 0, 0, 6, 0,
+        8, 0, 0, 0, 6, 0, 0, 0, 3,
+        4, 0, 0, 8, 0, 3, 0, 0, 1,
+        7, 0, 0, 0, 2, 0, 0, 0, 6,
+        0, 6, 0, 0, 0, 0, 2, 8, 0,
+        0, 0, 0, 4, 1, 9, 0, 0, 5,
+        0, 0, 0, 0, 8, 0, 0, 7, 9};
+
+    EXPECT_EQ(ss::count_solutions(grid.data(), 2), 1);
+
+    // nothing to count without a positive limit
+    EXPECT_EQ(ss::count_solutions(grid.data(), 0), 0);
+    EXPECT_EQ(ss::count_solutions(grid.data(), -1), 0);
+
+    // a missed digit leaves several solutions
+    std::vector<std::uint8_t> sparse_grid(81, 0);
+    sparse_grid[0] = 5;
+    EXPECT_EQ(ss::count_solutions(sparse_grid.data(), 2), 2);
+    EXPECT_EQ(ss::count_solutions(sparse_grid.data(), 10), 10);
+
+    // a misread digit leaves none
+    grid[2] = 5;
+    EXPECT_EQ(ss::count_solutions(grid.data(), 2), 0);
+}
+
+TEST(CorrectorTest, TestMisreadDigit) {
+    std::vector<std::uint8_t> expected_grid{
+        5, 3, 0, 0, 7, 0, 0, 0, 0,
+        6, 0, 0, 1, 9, 5, 0, 0, 0,
+        0, 9, 8, 0, 0, 0, 0, 6, 0,
+        8, 0, 0, 0, 6, 0, 0, 0, 3,
+        4, 0, 0, 8, 0, 3, 0, 0, 1,
+        7, 0, 0, 0, 2, 0, 0, 0, 6,
+        0, 6, 0, 0, 0, 0, 2, 8, 0,
+        0, 0, 0, 4, 1, 9, 0, 0, 5,
+        0, 0, 0, 0, 8, 0, 0, 7, 9};
+
+    // confident classification of every filled cell
+    std::vector<float> probabilities(81 * 9, 0.0f);
+    for (int i = 0; i < 81; ++i) {
+        if (expected_grid[i] == 0) continue;
+        std::fill(probabilities.begin() + i * 9, probabilities.begin() + i * 9 + 9, 0.001f);
+        probabilities[i * 9 + expected_grid[i] - 1] = 0.992f;
+    }
+
+    // first cell read as 3 (clashing with its neighbor), the 5 came second
+    std::vector<std::uint8_t> grid(expected_grid);
+    grid[0] = 3;
+    std::fill(probabilities.begin(), probabilities.begin() + 9, 0.005f);
+    probabilities[2] = 0.6f;
+    probabilities[4] = 0.365f;
+
+    // every filled cell has a digit's worth of ink
+    std::vector<float> blank_confidences(81, 0.0f);
+
+    EXPECT_TRUE(GridCorrector::correct(grid.data(), probabilities.data(), blank_confidences.data()));
+    EXPECT_EQ(grid, expected_grid);
+}
+
+TEST(CorrectorTest, TestSeveralSolutionsKept) {
+    // the 6 in the third row was missed, which leaves several solutions
+    std::vector<std::uint8_t> expected_grid{
+        5, 3, 0, 0, 7, 0, 0, 0, 0,
+        6, 0, 0, 1, 9, 5, 0, 0, 0,
+        0, 9, 8, 0, 0, 0, 0, 0, 0,
+        8, 0, 0, 0, 6, 0, 0, 0, 3,
+        4, 0, 0, 8, 0, 3, 0, 0, 1,
+        7, 0, 0, 0, 2, 0, 0, 0, 6,
+        0, 6, 0, 0, 0, 0, 2, 8, 0,
+        0, 0, 0, 4, 1, 9, 0, 0, 5,
+        0, 0, 0, 0, 8, 0, 0, 7, 9};
+    ASSERT_EQ(ss::count_solutions(expected_grid.data(), 2), 2);
+
+    std::vector<float> probabilities(81 * 9, 0.0f);
+    for (int i = 0; i < 81; ++i) {
+        if (expected_grid[i] == 0) continue;
+        std::fill(probabilities.begin() + i * 9, probabilities.begin() + i * 9 + 9, 0.001f);
+        probabilities[i * 9 + expected_grid[i] - 1] = 0.992f;
+    }
+
+    // the first 5 is doubtful, and reading it as 1 would give a unique grid,
+    // but the 1 is far less likely than the 5
+    std::fill(probabilities.begin(), probabilities.begin() + 9, 0.005f);
+    probabilities[4] = 0.85f;
+    probabilities[0] = 0.1f;
+    std::vector<float> blank_confidences(81, 0.0f);
+
+    std::vector<std::uint8_t> grid(expected_grid);
+    EXPECT_FALSE(GridCorrector::correct(grid.data(), probabilities.data(), blank_confidences.data()));
+    EXPECT_EQ(grid, expected_grid);
+}
+
+TEST(CorrectorTest, TestPhantomDigit) {
+    std::vector<std::uint8_t> expected_grid{
+        5, 3, 0, 0, 7, 0, 0, 0, 0,
+        6, 0, 0, 1, 9, 5, 0, 0, 0,
+        0, 9, 8, 0, 0, 0, 0, 6, 0,
+        8, 0, 0, 0, 6, 0, 0, 0, 3,
+        4, 0, 0, 8, 0, 3, 0, 0, 1,
+        7, 0, 0, 0, 2, 0, 0, 0, 6,
+        0, 6, 0, 0, 0, 0, 2, 8, 0,
+        0, 0, 0, 4, 1, 9, 0, 0, 5,
+        0, 0, 0, 0, 8, 0, 0, 7, 9};
+
+    std::vector<float> probabilities(81 * 9, 0.0f);
+    for (int i = 0; i < 81; ++i) {
+        if (expected_grid[i] == 0) continue;
+        std::fill(probabilities.begin() + i * 9, probabilities.begin() + i * 9 + 9, 0.001f);
+        probabilities[i * 9 + expected_grid[i] - 1] = 0.992f;
+    }
+    std::vector<float> blank_confidences(81, 0.0f);
+
+    // a speck in the third cell read as 5, clashing with the first cell
+    std::vector<std::uint8_t> grid(expected_grid);
+    grid[2] = 5;
+    std::fill(probabilities.begin() + 2 * 9, probabilities.begin() + 3 * 9, 0.05f);
+    probabilities[2 * 9 + 4] = 0.6f;
+    blank_confidences[2] = 0.8f;
+
+    EXPECT_TRUE(GridCorrector::correct(grid.data(), probabilities.data(), blank_confidences.data()));
+    EXPECT_EQ(grid, expected_grid);
+}
+
+TEST(BytesTest, TestInvalidSize) {
+    const std::uint8_t data[16] = {0xFF, 0xD8};
+    std::unique_ptr<ss::BoundingBox> bb(ss::detect_grid_from_bytes(context, data, -1));
+    EXPECT_EQ(bb->top_right.x, 0.0);
+
+    ss::BoundingBox full{{0, 0}, {1, 0}, {0, 1}, {1, 1}};
+    std::unique_ptr<std::uint8_t[]> grid(ss::extract_grid_from_bytes(context, data, -1, &full));
+    EXPECT_TRUE(std::all_of(grid.get(), grid.get() + 81, [](std::uint8_t digit) { return digit == 0; }));
+
+    EXPECT_EQ(ss::scan_open_from_bytes(context, data, -1), nullptr);
+    EXPECT_EQ(ss::scan_open_from_bytes(context, nullptr, 16), nullptr);
+}
+
+TEST(FrameTest, TestShortRowStride) {
+    std::vector<std::uint8_t> y_plane(64 * 48, 255);
+    ss::YuvFrame frame{};
+    frame.y_plane = y_plane.data();
+    frame.width = 64;
+    frame.height = 48;
+    frame.y_row_stride = 32;
+
+    std::unique_ptr<ss::BoundingBox> bb(ss::detect_grid_from_frame(context, &frame));
+    EXPECT_EQ(bb->top_right.x, 0.0);
+}
+
+TEST(ContextTest, TestMissingModel) {
+    EXPECT_EQ(ss::scanner_create((IMAGES_PATH + "/missing.tflite").c_str(), BACKEND_AUTO), nullptr);
+}
+
+TEST(ContextTest, TestModelFromBuffer) {
+    std::string image_path = IMAGES_PATH + "/1.jpg";
+    std::ifstream file(MODEL_PATH, std::ios::binary);
+    std::vector<std::uint8_t> model((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    ASSERT_FALSE(model.empty());
+
+    ss::ScannerContext *buffer_context = ss::scanner_create_from_buffer(model.data(), model.size(), BACKEND_AUTO);
+    ASSERT_NE(buffer_context, nullptr);
+
+    // the context keeps its own copy of the model
+    std::fill(model.begin(), model.end(), 0);
+    model.clear();
+
+    std::unique_ptr<ss::BoundingBox> bb(ss::detect_grid(context, image_path.c_str()));
+    std::unique_ptr<std::uint8_t[]> expected_grid(ss::extract_grid(context, image_path.c_str(), bb.get()));
+    std::unique_ptr<std::uint8_t[]> grid(ss::extract_grid(buffer_context, image_path.c_str(), bb.get()));
+
+    EXPECT_TRUE(std::equal(grid.get(), grid.get() + 81, expected_grid.get()));
+
+    ss::scanner_destroy(buffer_context);
+}
+
+TEST(ContextTest, TestWarmup) {
+    std::string image_path = IMAGES_PATH + "/1.jpg";
+    ss::ScannerContext *warm_context = ss::scanner_create(MODEL_PATH.c_str(), BACKEND_AUTO);
+    ASSERT_NE(warm_context, nullptr);
+
+    EXPECT_TRUE(ss::scanner_warmup(warm_context));
+
+    // warm-up must not count as a detection
+    ss::DetectionStatistics detection;
+    ss::get_detection_statistics(warm_context, &detection);
+    EXPECT_EQ(detection.detections, 0u);
+
+    ss::ClassifierStatistics classifier;
+    ss::get_classifier_statistics(warm_context, &classifier);
+    EXPECT_GE(classifier.checkouts, classifier.pool_size);
+
+    // and must leave the interpreters in a usable state
+    std::unique_ptr<ss::BoundingBox> bb(ss::detect_grid(context, image_path.c_str()));
+    std::unique_ptr<std::uint8_t[]> expected_grid(ss::extract_grid(context, image_path.c_str(), bb.get()));
+    std::unique_ptr<std::uint8_t[]> grid(ss::extract_grid(warm_context, image_path.c_str(), bb.get()));
+    EXPECT_TRUE(std::equal(grid.get(), grid.get() + 81, expected_grid.get()));
+
+    ss::scanner_destroy(warm_context);
+}
+
+TEST(ContextTest, TestBackendSelection) {
+    ss::BackendInfo info;
+    ss::get_backend_info(context, &info);
+
+    ASSERT_GE(info.backend, BACKEND_CPU);
+    ASSERT_LT(info.backend, BACKEND_COUNT);
+    EXPECT_GE(info.threads, 1);
+
+    // the shared context ran the benchmark, so it picked the fastest backend
+    if (!info.cached) {
+        EXPECT_GT(info.benchmark_us[info.backend], 0u);
+
+        for (int i = 0; i < BACKEND_COUNT; ++i) {
+            if (info.benchmark_us[i] > 0) {
+                EXPECT_LE(info.benchmark_us[info.backend], info.benchmark_us[i]);
+            }
+        }
+    }
+
+    // later contexts reuse the choice
+    ss::ScannerContext *cached_context = ss::scanner_create(MODEL_PATH.c_str(), BACKEND_AUTO);
+    ASSERT_NE(cached_context, nullptr);
+    ss::BackendInfo cached_info;
+    ss::get_backend_info(cached_context, &cached_info);
+    EXPECT_TRUE(cached_info.cached);
+    EXPECT_EQ(cached_info.backend, info.backend);
+    ss::scanner_destroy(cached_context);
+
+    // the choice is keyed on the model content, not on how it was loaded
+    std::ifstream file(MODEL_PATH, std::ios::binary);
+    std::vector<std::uint8_t> model((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    ss::ScannerContext *buffer_context = ss::scanner_create_from_buffer(model.data(), model.size(), BACKEND_AUTO);
+    ASSERT_NE(buffer_context, nullptr);
+    ss::BackendInfo buffer_info;
+    ss::get_backend_info(buffer_context, &buffer_info);
+    EXPECT_TRUE(buffer_info.cached);
+    EXPECT_EQ(buffer_info.backend, info.backend);
+    EXPECT_NE(buffer_info.model_hash, 0u);
+    EXPECT_EQ(buffer_info.model_hash, cached_info.model_hash);
+    ss::scanner_destroy(buffer_context);
+
+    // the cpu is always available
+    ss::ScannerContext *cpu_context = ss::scanner_create(MODEL_PATH.c_str(), BACKEND_CPU);
+    ASSERT_NE(cpu_context, nullptr);
+    ss::BackendInfo cpu_info;
+    ss::get_backend_info(cpu_context, &cpu_info);
+    EXPECT_EQ(cpu_info.backend, BACKEND_CPU);
+    EXPECT_FALSE(cpu_info.cached);
+    ss::scanner_destroy(cpu_context);
+
+    EXPECT_EQ(ss::scanner_create(MODEL_PATH.c_str(), BACKEND_COUNT), nullptr);
+}
+
+TEST(ContextTest, TestConcurrentScans) {
+    std::string image_path = IMAGES_PATH + "/1.jpg";
+
+    std::unique_ptr<ss::BoundingBox> bb(ss::detect_grid(context, image_path.c_str()));
+    std::unique_ptr<std::uint8_t[]> expected_grid(ss::extract_grid(context, image_path.c_str(), bb.get()));
+
+    // every thread scans on the shared context and has to get the same grid
+    const int thread_count = 4;
+    std::vector<int> mismatches(thread_count, 0);
+    std::vector<std::thread> threads;
+
+    for (int t = 0; t < thread_count; ++t) {
+        threads.emplace_back([&, t]() {
+            for (int i = 0; i < 3; ++i) {
+                std::unique_ptr<ss::BoundingBox> thread_bb(ss::detect_grid(context, image_path.c_str()));
+                std::unique_ptr<std::uint8_t[]> grid(ss::extract_grid(context, image_path.c_str(), thread_bb.get()));
+
+                if (!std::equal(grid.get(), grid.get() + 81, expected_grid.get())) {
+                    mismatches[t]++;
+                }
+            }
+        });
+    }
+
+    for (auto &thread : threads) thread.join();
+
+    EXPECT_EQ(std::accumulate(mismatches.begin(), mismatches.end(), 0), 0);
+}
+
+TEST(ContextTest, TestClassifierStatistics) {
+    std::string image_path = IMAGES_PATH + "/1.jpg";
+    std::unique_ptr<ss::BoundingBox> bb(ss::detect_grid(context, image_path.c_str()));
+
+    ss::ClassifierStatistics before;
+    ss::get_classifier_statistics(context, &before);
+    std::unique_ptr<std::uint8_t[]> grid(ss::extract_grid(context, image_path.c_str(), bb.get()));
+    ss::ClassifierStatistics after;
+    ss::get_classifier_statistics(context, &after);
+
+    EXPECT_GE(after.pool_size, 1u);
+    EXPECT_LE(after.peak_in_use, after.pool_size);
+    EXPECT_EQ(after.checkouts, before.checkouts + 1);
+    EXPECT_LE(after.contended_checkouts, after.checkouts);
+}
+
 int main(int argc, char **argv) {
     testing::InitGoogleTest(&argc, argv);
-    ss::set_model((char *)MODEL_PATH.c_str());
-    return RUN_ALL_TESTS();
+    context = ss::scanner_create(MODEL_PATH.c_str(), BACKEND_AUTO);
+
+    if (!context) {
+        printf("Could not load model %s\n", MODEL_PATH.c_str());
+        return 1;
+    }
+
+    int result = RUN_ALL_TESTS();
+    ss::scanner_destroy(context);
+
+    return result;
 }
@@ -0,0 +1,23 @@
+import 'dart:typed_data';
+
+/// Raw frame from the camera image stream (YUV_420_888 / NV21).
+///
+/// Only the luminance (Y) plane is needed, because the scanner works on
+/// grayscale images anyway.
+class CameraFrame {
+  Uint8List yPlane;
+  int width;
+  int height;
+  int bytesPerRow;
+
+  /// Clockwise rotation (0, 90, 180, 270) to get the upright image.
+  int rotation;
+
+  CameraFrame({
+    required this.yPlane,
+    required this.width,
+    required this.height,
+    required this.bytesPerRow,
+    this.rotation = 0,
+  });
+}
@@ -0,0 +1,30 @@
+import 'dart:ui';
+
+/// Everything extraction knows about one cell of a scanned grid.
+class CellResult {
+  /// Recognized digit, 0 for blank cells.
+  final int digit;
+
+  /// Classifier output for the digits 1 to 9, all 0 for blank cells.
+  final List<double> probabilities;
+
+  /// Digit in the perspective corrected grid image, which is
+  /// [warpedGridSize] pixels wide. Empty for blank cells.
+  final Rect boundingBox;
+
+  /// 1 without any ink around the cell center, falling to 0 as the ink grows
+  /// to the size of a digit.
+  final double blankConfidence;
+
+  static const int warpedGridSize = 450;
+
+  CellResult({
+    required this.digit,
+    required this.probabilities,
+    required this.boundingBox,
+    required this.blankConfidence,
+  });
+
+  /// Probability of [digit], 0 for blank cells.
+  double get confidence => digit == 0 ? 0 : probabilities[digit - 1];
+}
@@ -1,12 +1,14 @@
 import 'dart:ffi';
 import 'dart:io';
 import 'dart:typed_data';
-import 'dart:ui' show Offset;
+import 'dart:ui' show Offset, Rect;
 import 'package:ffi/ffi.dart';
 import 'package:flutter/foundation.dart' show compute;
 import 'package:path_provider/path_provider.dart';
 import 'package:flutter/services.dart' show rootBundle;
 import 'bounding_box.dart';
+import 'camera_frame.dart';
+import 'cell_result.dart';
 import 'sudoku_scanner_bindings_generated.dart' as native;
 
 const String _libName = 'sudoku_scanner';
@@ -14,37 +16,151 @@ const String _libName = 'sudoku_scanner';
 class SudokuScanner {
   static late final native.SudokuScannerBindings _bindings;
 
+  /// Address of the native scanner context, which owns the model and the
+  /// detection tuning. Kept as an address, so it can be captured by the
+  /// closures passed to [compute].
+  static late final int _contextAddress;
+
+  /// Completes with true once the native scanner is warmed up, see [init].
+  /// Scans work before that, the first one is just slower.
+  static late final Future<bool> ready;
+
   /// Initializes and loads the tensorflow model.
   ///
   /// The neural network model - used for classifying printed digits - is
-  /// encoded in the app package. Because of this native C++ Tensorflow
-  /// cannot read the model straight from assets. Therefore we read and
-  /// decode the model first and save it then to the app's folder. This only
-  /// needs to be done once.
-  static Future<void> init() async {
+  /// encoded in the app package. It is handed to native code straight from
+  /// the asset bundle, which keeps its own copy for the app's lifetime, so
+  /// nothing has to be written to storage.
+  ///
+  /// Loading happens on a background isolate. Afterwards the scanner is
+  /// warmed up in the background as well, so the first scan doesn't have to
+  /// prepare the model; [ready] tells when that is done.
+  ///
+  /// Without [backend] every available [InferenceBackend] is benchmarked and
+  /// the fastest is used. The choice is stored in the app's support
+  /// directory and reused on later launches until the model changes, so
+  /// only the first launch pays for the benchmark.
+  static Future<void> init({InferenceBackend? backend}) async {
     if (!Platform.isAndroid) {
       throw UnsupportedError(
           'Unsupported platform: ${Platform.operatingSystem}');
     }
 
-    final extDir = await getExternalStorageDirectory();
-    final tfliteModelPath = "${extDir!.path}/model.tflite";
+    final tfliteModel =
+        await rootBundle.load('packages/sudoku_scanner/assets/model.tflite');
+
+    _bindings = _getBindings();
+
+    final modelBytes = tfliteModel.buffer.asUint8List(
+      tfliteModel.offsetInBytes,
+      tfliteModel.lengthInBytes,
+    );
+
+    final storedChoice = backend == null ? await _loadBackendChoice() : null;
+    final nativeBackend =
+        backend?.index ?? storedChoice?.backend ?? native.BACKEND_AUTO;
+
+    final (contextAddress, modelHash, benchmarked) = await compute((_) {
+      // [DynamicLibrary] can't be passed through Isolate Ports, so we need to create new one
+      final bindings = _getBindings();
+
+      final modelPointer = _copyToNative(modelBytes);
+      var context = bindings.scanner_create_from_buffer(
+          modelPointer, modelBytes.length, nativeBackend);
+      var benchmarked = nativeBackend == native.BACKEND_AUTO;
 
-    if (!await File(tfliteModelPath).exists()) {
-      var tfliteModel =
-          await rootBundle.load('packages/sudoku_scanner/assets/model.tflite');
+      // the stored choice was made for another model, benchmark this one
+      if (context != nullptr &&
+          storedChoice != null &&
+          _readModelHash(bindings, context) != storedChoice.modelHash) {
+        bindings.scanner_destroy(context);
+        context = bindings.scanner_create_from_buffer(
+            modelPointer, modelBytes.length, native.BACKEND_AUTO);
+        benchmarked = true;
+      }
+      malloc.free(modelPointer);
 
-      File(tfliteModelPath).writeAsBytes(tfliteModel.buffer.asUint8List(
-        tfliteModel.offsetInBytes,
-        tfliteModel.lengthInBytes,
-      ));
+      final modelHash =
+          context == nullptr ? 0 : _readModelHash(bindings, context);
+      return (context.address, modelHash, benchmarked);
+    }, null);
+
+    if (contextAddress == 0) {
+      throw StateError('Could not load the model from the assets');
     }
 
-    _bindings = _getBindings();
+    _contextAddress = contextAddress;
+    ready = _warmUp();
 
-    _setModel(tfliteModelPath);
+    if (benchmarked) {
+      await _saveBackendChoice(modelHash, getBackendInfo().backend);
+    }
+  }
+
+  /// File keeping the benchmarked backend as `<model hash> <backend id>`.
+  static Future<File> _backendChoiceFile() async {
+    final supportDir = await getApplicationSupportDirectory();
+    return File('${supportDir.path}/sudoku_scanner_backend');
+  }
+
+  /// Backend id stored by an earlier launch and the hash of the model it was
+  /// benchmarked for, if any.
+  static Future<({int modelHash, int backend})?> _loadBackendChoice() async {
+    try {
+      final fields =
+          (await (await _backendChoiceFile()).readAsString()).split(' ');
+      if (fields.length != 2) return null;
+
+      final modelHash = int.tryParse(fields[0]);
+      final backend = int.tryParse(fields[1]);
+      if (modelHash == null ||
+          backend == null ||
+          backend < 0 ||
+          backend >= InferenceBackend.values.length) {
+        return null;
+      }
+      return (modelHash: modelHash, backend: backend);
+    } on Exception {
+      return null;
+    }
+  }
+
+  static Future<void> _saveBackendChoice(
+      int modelHash, InferenceBackend backend) async {
+    try {
+      await (await _backendChoiceFile())
+          .writeAsString('$modelHash ${backend.index}');
+    } on Exception {
+      // benchmarked again on the next launch
+    }
   }
 
+  /// Hash of the context's model, computed natively when it was loaded.
+  static int _readModelHash(native.SudokuScannerBindings bindings,
+      Pointer<native.ScannerContext> context) {
+    final infoPointer = malloc<native.BackendInfo>();
+    bindings.get_backend_info(context, infoPointer);
+    final modelHash = infoPointer.ref.model_hash;
+    malloc.free(infoPointer);
+
+    return modelHash;
+  }
+
+  static Future<bool> _warmUp() {
+    final contextAddress = _contextAddress;
+
+    return compute((_) {
+      // [DynamicLibrary] can't be passed through Isolate Ports, so we need to create new one
+      final bindings = _getBindings();
+
+      return bindings.scanner_warmup(
+          Pointer<native.ScannerContext>.fromAddress(contextAddress));
+    }, null);
+  }
+
+  static Pointer<native.ScannerContext> get _context =>
+      Pointer<native.ScannerContext>.fromAddress(_contextAddress);
+
   static native.SudokuScannerBindings _getBindings() {
     /// The dynamic library in which the symbols for [SudokuScannerBindings] can be found.
     final DynamicLibrary dylib = DynamicLibrary.open('lib$_libName.so');
@@ -55,10 +171,108 @@ class SudokuScanner {
     return bindings;
   }
 
-  static void _setModel(String path) {
-    final pathPointer = path.toNativeUtf8().cast<Char>();
-    _bindings.set_model(pathPointer);
-    malloc.free(pathPointer);
+  /// Evaluates all detection thresholds in parallel instead of one after
+  /// another. Worst case detection gets faster on multi-core devices, but
+  /// easy images cost more total CPU time.
+  static void setParallelDetection(bool enabled) {
+    _bindings.set_parallel_detection(_context, enabled);
+  }
+
+  /// Lets detection try the threshold settings first that succeeded most
+  /// often for images with similar lighting.
+  static void setAdaptiveDetection(bool enabled) {
+    _bindings.set_adaptive_detection(_context, enabled);
+  }
+
+  static DetectionStatistics getDetectionStatistics() {
+    final statisticsPointer = malloc<native.DetectionStatistics>();
+    _bindings.get_detection_statistics(_context, statisticsPointer);
+
+    final ns = statisticsPointer.ref;
+    final statistics = DetectionStatistics(
+      detections: ns.detections,
+      successes: ns.successes,
+      thresholdPasses: ns.threshold_passes,
+      settingSuccesses: List.generate(native.THRESHOLD_SETTING_COUNT,
+          (index) => ns.setting_successes[index],
+          growable: false),
+    );
+
+    malloc.free(statisticsPointer);
+
+    return statistics;
+  }
+
+  static void resetDetectionStatistics() {
+    _bindings.reset_detection_statistics(_context);
+  }
+
+  static BackendInfo getBackendInfo() {
+    final infoPointer = malloc<native.BackendInfo>();
+    _bindings.get_backend_info(_context, infoPointer);
+
+    final ni = infoPointer.ref;
+    final info = BackendInfo(
+      backend: InferenceBackend.values[ni.backend],
+      threads: ni.threads,
+      benchmarks: {
+        for (final backend in InferenceBackend.values)
+          if (ni.benchmark_us[backend.index] > 0)
+            backend: Duration(microseconds: ni.benchmark_us[backend.index]),
+      },
+      cached: ni.cached,
+    );
+
+    malloc.free(infoPointer);
+
+    return info;
+  }
+
+  static ClassifierStatistics getClassifierStatistics() {
+    final statisticsPointer = malloc<native.ClassifierStatistics>();
+    _bindings.get_classifier_statistics(_context, statisticsPointer);
+
+    final ns = statisticsPointer.ref;
+    final statistics = ClassifierStatistics(
+      poolSize: ns.pool_size,
+      checkouts: ns.checkouts,
+      contendedCheckouts: ns.contended_checkouts,
+      peakInUse: ns.peak_in_use,
+    );
+
+    malloc.free(statisticsPointer);
+
+    return statistics;
+  }
+
+  /// Stage timings and counters of the latest scan on the scanner context,
+  /// see [ScanStats].
+  static ScanStats getScanStats() {
+    final statsPointer = malloc<native.ScanStats>();
+    _bindings.get_scan_stats(_context, statsPointer);
+
+    final ns = statsPointer.ref;
+    final stats = ScanStats(
+      enabled: ns.enabled,
+      decode: Duration(microseconds: ns.decode_us),
+      preprocess: Duration(microseconds: ns.preprocess_us),
+      locateGrid: Duration(microseconds: ns.locate_grid_us),
+      warp: Duration(microseconds: ns.warp_us),
+      binarize: Duration(microseconds: ns.binarize_us),
+      removeGridLines: Duration(microseconds: ns.remove_grid_lines_us),
+      extractCells: Duration(microseconds: ns.extract_cells_us),
+      predictNumbers: Duration(microseconds: ns.predict_numbers_us),
+      correctNumbers: Duration(microseconds: ns.correct_numbers_us),
+      thresholdPasses: ns.threshold_passes,
+      quadrilaterals: ns.quadrilaterals,
+      rejectedQuadrilaterals: ns.rejected_quadrilaterals,
+      cells: ns.cells,
+      correctedCells: ns.corrected_cells,
+    );
+
+    malloc.free(statsPointer);
+
+    return stats;
   }
 
   static void _freePointer(Pointer pointer) {
@@ -66,13 +280,17 @@ class SudokuScanner {
   }
 
   static Future<BoundingBox> detectGrid(String imagePath) async {
+    final contextAddress = _contextAddress;
     final nativeboundingBoxAdress = await compute((_) {
       // [DynamicLibrary] can't be passed through Isolate Ports, so we need to create new one
       final bindings = _getBindings();
+      final context =
+          Pointer<native.ScannerContext>.fromAddress(contextAddress);
 
       final imagePathPointer = imagePath.toNativeUtf8().cast<Char>();
 
-      final nativeBoundingBoxPointer = bindings.detect_grid(imagePathPointer);
+      final nativeBoundingBoxPointer =
+          bindings.detect_grid(context, imagePathPointer);
       malloc.free(imagePathPointer);
 
       return nativeBoundingBoxPointer.address;
@@ -95,9 +313,12 @@ class SudokuScanner {
 
   static Future<Uint8List> extractGrid(
       String imagePath, BoundingBox boundingBox) async {
+    final contextAddress = _contextAddress;
     final gridArrayAddress = await compute((_) {
       // [DynamicLibrary] can't be passed through Isolate Ports, so we need to create new one
       final bindings = _getBindings();
+      final context =
+          Pointer<native.ScannerContext>.fromAddress(contextAddress);
 
       final imagePathPointer = imagePath.toNativeUtf8().cast<Char>();
       final nativeBoundingBoxPointer = malloc<native.BoundingBox>();
@@ -112,8 +333,8 @@ class SudokuScanner {
         ..bottom_right.x = boundingBox.bottomRight.dx
         ..bottom_right.y = boundingBox.bottomRight.dy;
 
-      Pointer<Uint8> gridArray =
-          bindings.extract_grid(imagePathPointer, nativeBoundingBoxPointer);
+      Pointer<Uint8> gridArray = bindings.extract_grid(
+          context, imagePathPointer, nativeBoundingBoxPointer);
 
       malloc.free(imagePathPointer);
       malloc.free(nativeBoundingBoxPointer);
@@ -131,14 +352,17 @@ class SudokuScanner {
 
   static Future<Uint8List> extractGridfromRoi(
       String imagePath, int roiSize, int roiOffset) async {
+    final contextAddress = _contextAddress;
     final gridArrayAddress = await compute((_) {
       // [DynamicLibrary] can't be passed through Isolate Ports, so we need to create new one
       final bindings = _getBindings();
+      final context =
+          Pointer<native.ScannerContext>.fromAddress(contextAddress);
 
       final imagePathPointer = imagePath.toNativeUtf8().cast<Char>();
 
-      final gridArray =
-          bindings.extract_grid_from_roi(imagePathPointer, roiSize, roiOffset);
+      final gridArray = bindings.extract_grid_from_roi(
+          context, imagePathPointer, roiSize, roiOffset);
 
       malloc.free(imagePathPointer);
 
@@ -152,4 +376,766 @@ class SudokuScanner {
 
     return gridList;
   }
+
+  /// Same as [extractGrid], but returns everything known about each cell
+  /// (row-major) instead of only the digits. Returns null if the image could
+  /// not be read.
+  static Future<List<CellResult>?> extractGridDetails(
+      String imagePath, BoundingBox boundingBox) async {
+    final contextAddress = _contextAddress;
+    final resultAddress = await compute((_) {
+      // [DynamicLibrary] can't be passed through Isolate Ports, so we need to create new one
+      final bindings = _getBindings();
+      final context =
+          Pointer<native.ScannerContext>.fromAddress(contextAddress);
+
+      final imagePathPointer = imagePath.toNativeUtf8().cast<Char>();
+      final nativeBoundingBoxPointer = malloc<native.BoundingBox>();
+      final resultPointer = malloc<native.GridResult>();
+
+      nativeBoundingBoxPointer.ref
+        ..top_left.x = boundingBox.topLeft.dx
+        ..top_left.y = boundingBox.topLeft.dy
+        ..top_right.x = boundingBox.topRight.dx
+        ..top_right.y = boundingBox.topRight.dy
+        ..bottom_left.x = boundingBox.bottomLeft.dx
+        ..bottom_left.y = boundingBox.bottomLeft.dy
+        ..bottom_right.x = boundingBox.bottomRight.dx
+        ..bottom_right.y = boundingBox.bottomRight.dy;
+
+      final success = bindings.extract_grid_details(
+          context, imagePathPointer, nativeBoundingBoxPointer, resultPointer);
+
+      malloc.free(imagePathPointer);
+      malloc.free(nativeBoundingBoxPointer);
+
+      if (!success) {
+        malloc.free(resultPointer);
+        return 0;
+      }
+
+      return resultPointer.address;
+    }, null);
+
+    return _readGridResult(resultAddress);
+  }
+
+  /// Converts and frees the native result at [resultAddress], 0 means none.
+  static List<CellResult>? _readGridResult(int resultAddress) {
+    if (resultAddress == 0) return null;
+
+    final resultPointer = Pointer<native.GridResult>.fromAddress(resultAddress);
+    final cells = List.generate(81, (index) {
+      final cell = resultPointer.ref.cells[index];
+      return CellResult(
+        digit: cell.digit,
+        probabilities: List.generate(9, (digit) => cell.probabilities[digit],
+            growable: false),
+        boundingBox: Rect.fromLTWH(cell.x.toDouble(), cell.y.toDouble(),
+            cell.width.toDouble(), cell.height.toDouble()),
+        blankConfidence: cell.blank_confidence,
+      );
+    }, growable: false);
+
+    malloc.free(resultPointer);
+
+    return cells;
+  }
+
+  /// Same as [detectGrid], but takes the encoded image (e.g. JPEG) directly
+  /// instead of reading it from storage.
+  ///
+  /// Native code decodes straight from the buffer, but [imageBytes] live on
+  /// the Dart heap, which can't be handed to a long running native call, so
+  /// they are copied once into native memory on the calling isolate.
+  static Future<BoundingBox> detectGridFromBytes(Uint8List imageBytes) async {
+    final contextAddress = _contextAddress;
+    final imageAddress = _moveToNative(imageBytes);
+    final imageSize = imageBytes.length;
+    final nativeboundingBoxAdress = await compute((_) {
+      // [DynamicLibrary] can't be passed through Isolate Ports, so we need to create new one
+      final bindings = _getBindings();
+      final context =
+          Pointer<native.ScannerContext>.fromAddress(contextAddress);
+
+      final imagePointer = Pointer<Uint8>.fromAddress(imageAddress);
+
+      final nativeBoundingBoxPointer =
+          bindings.detect_grid_from_bytes(context, imagePointer, imageSize);
+      malloc.free(imagePointer);
+
+      return nativeBoundingBoxPointer.address;
+    }, null);
+
+    final nativeBoundingBoxPointer =
+        Pointer<native.BoundingBox>.fromAddress(nativeboundingBoxAdress);
+    final nbb = nativeBoundingBoxPointer.ref;
+    final bb = BoundingBox(
+      topLeft: Offset(nbb.top_left.x, nbb.top_left.y),
+      topRight: Offset(nbb.top_right.x, nbb.top_right.y),
+      bottomLeft: Offset(nbb.bottom_left.x, nbb.bottom_left.y),
+      bottomRight: Offset(nbb.bottom_right.x, nbb.bottom_right.y),
+    );
+
+    _freePointer(nativeBoundingBoxPointer);
+
+    return bb;
+  }
+
+  /// Same as [extractGrid], but takes the encoded image (e.g. JPEG) directly
+  /// instead of reading it from storage. Copies [imageBytes] once, like
+  /// [detectGridFromBytes].
+  static Future<Uint8List> extractGridFromBytes(
+      Uint8List imageBytes, BoundingBox boundingBox) async {
+    final contextAddress = _contextAddress;
+    final imageAddress = _moveToNative(imageBytes);
+    final imageSize = imageBytes.length;
+    final gridArrayAddress = await compute((_) {
+      // [DynamicLibrary] can't be passed through Isolate Ports, so we need to create new one
+      final bindings = _getBindings();
+      final context =
+          Pointer<native.ScannerContext>.fromAddress(contextAddress);
+
+      final imagePointer = Pointer<Uint8>.fromAddress(imageAddress);
+      final nativeBoundingBoxPointer = malloc<native.BoundingBox>();
+
+      nativeBoundingBoxPointer.ref
+        ..top_left.x = boundingBox.topLeft.dx
+        ..top_left.y = boundingBox.topLeft.dy
+        ..top_right.x = boundingBox.topRight.dx
+        ..top_right.y = boundingBox.topRight.dy
+        ..bottom_left.x = boundingBox.bottomLeft.dx
+        ..bottom_left.y = boundingBox.bottomLeft.dy
+        ..bottom_right.x = boundingBox.bottomRight.dx
+        ..bottom_right.y = boundingBox.bottomRight.dy;
+
+      Pointer<Uint8> gridArray = bindings.extract_grid_from_bytes(
+          context, imagePointer, imageSize, nativeBoundingBoxPointer);
+
+      malloc.free(imagePointer);
+      malloc.free(nativeBoundingBoxPointer);
+
+      return gridArray.address;
+    }, null);
+
+    final gridArray = Pointer<Uint8>.fromAddress(gridArrayAddress);
+
+    final gridList =
+        gridArray.asTypedList(81, finalizer: _bindings.free_pointerPtr);
+
+    return gridList;
+  }
+
+  /// Same as [extractGridfromRoi], but takes the encoded image (e.g. JPEG)
+  /// directly instead of reading it from storage. Copies [imageBytes] once,
+  /// like [detectGridFromBytes].
+  static Future<Uint8List> extractGridfromRoiBytes(
+      Uint8List imageBytes, int roiSize, int roiOffset) async {
+    final contextAddress = _contextAddress;
+    final imageAddress = _moveToNative(imageBytes);
+    final imageSize = imageBytes.length;
+    final gridArrayAddress = await compute((_) {
+      // [DynamicLibrary] can't be passed through Isolate Ports, so we need to create new one
+      final bindings = _getBindings();
+      final context =
+          Pointer<native.ScannerContext>.fromAddress(contextAddress);
+
+      final imagePointer = Pointer<Uint8>.fromAddress(imageAddress);
+
+      final gridArray = bindings.extract_grid_from_roi_bytes(
+          context, imagePointer, imageSize, roiSize, roiOffset);
+
+      malloc.free(imagePointer);
+
+      return gridArray.address;
+    }, null);
+
+    final gridArray = Pointer<Uint8>.fromAddress(gridArrayAddress);
+
+    final gridList =
+        gridArray.asTypedList(81, finalizer: _bindings.free_pointerPtr);
+
+    return gridList;
+  }
+
+  /// Same as [detectGrid], but works on a raw frame of the camera image
+  /// stream, so no JPEG has to be encoded and decoded.
+  ///
+  /// The Y plane of [frame] lives on the Dart heap, so it is copied once
+  /// into native memory on the calling isolate, like the bytes of
+  /// [detectGridFromBytes].
+  static Future<BoundingBox> detectGridFromFrame(CameraFrame frame) async {
+    final contextAddress = _contextAddress;
+    final frameAddress = _moveFrameToNative(frame);
+    final nativeboundingBoxAdress = await compute((_) {
+      // [DynamicLibrary] can't be passed through Isolate Ports, so we need to create new one
+      final bindings = _getBindings();
+      final context =
+          Pointer<native.ScannerContext>.fromAddress(contextAddress);
+
+      final nativeFramePointer =
+          Pointer<native.YuvFrame>.fromAddress(frameAddress);
+
+      final nativeBoundingBoxPointer =
+          bindings.detect_grid_from_frame(context, nativeFramePointer);
+
+      _freeFrame(nativeFramePointer);
+
+      return nativeBoundingBoxPointer.address;
+    }, null);
+
+    final nativeBoundingBoxPointer =
+        Pointer<native.BoundingBox>.fromAddress(nativeboundingBoxAdress);
+    final nbb = nativeBoundingBoxPointer.ref;
+    final bb = BoundingBox(
+      topLeft: Offset(nbb.top_left.x, nbb.top_left.y),
+      topRight: Offset(nbb.top_right.x, nbb.top_right.y),
+      bottomLeft: Offset(nbb.bottom_left.x, nbb.bottom_left.y),
+      bottomRight: Offset(nbb.bottom_right.x, nbb.bottom_right.y),
+    );
+
+    _freePointer(nativeBoundingBoxPointer);
+
+    return bb;
+  }
+
+  /// Same as [extractGrid], but works on a raw frame of the camera image
+  /// stream, so no JPEG has to be encoded and decoded. Copies the Y plane
+  /// once, like [detectGridFromFrame].
+  static Future<Uint8List> extractGridFromFrame(
+      CameraFrame frame, BoundingBox boundingBox) async {
+    final contextAddress = _contextAddress;
+    final frameAddress = _moveFrameToNative(frame);
+    final gridArrayAddress = await compute((_) {
+      // [DynamicLibrary] can't be passed through Isolate Ports, so we need to create new one
+      final bindings = _getBindings();
+      final context =
+          Pointer<native.ScannerContext>.fromAddress(contextAddress);
+
+      final nativeFramePointer =
+          Pointer<native.YuvFrame>.fromAddress(frameAddress);
+      final nativeBoundingBoxPointer = malloc<native.BoundingBox>();
+
+      nativeBoundingBoxPointer.ref
+        ..top_left.x = boundingBox.topLeft.dx
+        ..top_left.y = boundingBox.topLeft.dy
+        ..top_right.x = boundingBox.topRight.dx
+        ..top_right.y = boundingBox.topRight.dy
+        ..bottom_left.x = boundingBox.bottomLeft.dx
+        ..bottom_left.y = boundingBox.bottomLeft.dy
+        ..bottom_right.x = boundingBox.bottomRight.dx
+        ..bottom_right.y = boundingBox.bottomRight.dy;
+
+      Pointer<Uint8> gridArray = bindings.extract_grid_from_frame(
+          context, nativeFramePointer, nativeBoundingBoxPointer);
+
+      _freeFrame(nativeFramePointer);
+      malloc.free(nativeBoundingBoxPointer);
+
+      return gridArray.address;
+    }, null);
+
+    final gridArray = Pointer<Uint8>.fromAddress(gridArrayAddress);
+
+    final gridList =
+        gridArray.asTypedList(81, finalizer: _bindings.free_pointerPtr);
+
+    return gridList;
+  }
+
+  /// Solves [grid] (81 values in row-major order, 0 for empty cells) and
+  /// returns the filled in grid, or null if it has no solution.
+  ///
+  /// The native solver is fast enough even for hard puzzles, so unlike the
+  /// scanning calls this runs on the calling isolate.
+  static Uint8List? solveGrid(Uint8List grid) {
+    assert(grid.length == 81);
+
+    final gridPointer = _copyToNative(grid);
+    final solved = _bindings.solve_grid(gridPointer, gridPointer);
+
+    final solution =
+        solved ? Uint8List.fromList(gridPointer.asTypedList(81)) : null;
+    malloc.free(gridPointer);
+
+    return solution;
+  }
+
+  /// Counts the solutions of [grid], but stops at [limit].
+  ///
+  /// With the default limit of 2 this tells right after extraction whether
+  /// the scan is a proper Sudoku (1), contains a misread digit (0) or misses
+  /// digits (2). Returns 0 if [limit] is not positive.
+  static int countSolutions(Uint8List grid, {int limit = 2}) {
+    assert(grid.length == 81);
+
+    final gridPointer = _copyToNative(grid);
+    final count = _bindings.count_solutions(gridPointer, limit);
+    malloc.free(gridPointer);
+
+    return count;
+  }
+
+  /// Describes [frame] in native memory, which has to be freed by the caller.
+  static Pointer<native.YuvFrame> _frameToNative(
+      CameraFrame frame, Pointer<Uint8> yPlanePointer) {
+    final nativeFramePointer = calloc<native.YuvFrame>();
+
+    nativeFramePointer.ref
+      ..y_plane = yPlanePointer
+      ..width = frame.width
+      ..height = frame.height
+      ..y_row_stride = frame.bytesPerRow
+      ..rotation = frame.rotation;
+
+    return nativeFramePointer;
+  }
+
+  /// Same as [_moveToNative] for a whole frame, returns the address of the
+  /// native frame, which has to be freed with [_freeFrame].
+  static int _moveFrameToNative(CameraFrame frame) =>
+      _frameToNative(frame, _copyToNative(frame.yPlane)).address;
+
+  /// Frees a frame built by [_moveFrameToNative] together with its Y plane.
+  static void _freeFrame(Pointer<native.YuvFrame> nativeFramePointer) {
+    malloc.free(nativeFramePointer.ref.y_plane);
+    calloc.free(nativeFramePointer);
+  }
+
+  /// Decodes the image at [imagePath] once and keeps it in native memory for
+  /// repeated detection and extraction. Returns null if the image could not
+  /// be decoded. The session has to be closed with [ScanSession.close].
+  static Future<ScanSession?> openSession(String imagePath) async {
+    final contextAddress = _contextAddress;
+    final sessionAddress = await compute((_) {
+      // [DynamicLibrary] can't be passed through Isolate Ports, so we need to create new one
+      final bindings = _getBindings();
+      final context =
+          Pointer<native.ScannerContext>.fromAddress(contextAddress);
+
+      final imagePathPointer = imagePath.toNativeUtf8().cast<Char>();
+
+      final sessionPointer = bindings.scan_open(context, imagePathPointer);
+      malloc.free(imagePathPointer);
+
+      return sessionPointer.address;
+    }, null);
+
+    if (sessionAddress == 0) return null;
+
+    return ScanSession._(sessionAddress);
+  }
+
+  /// Copies [bytes] into native memory, which has to be freed by the caller.
+  static Pointer<Uint8> _copyToNative(Uint8List bytes) {
+    final pointer = malloc<Uint8>(bytes.length);
+    pointer.asTypedList(bytes.length).setAll(0, bytes);
+    return pointer;
+  }
+
+  /// Copies large input for a [compute] call into native memory and returns
+  /// its address, which the background isolate has to free.
+  ///
+  /// Capturing the [Uint8List] in the closure would copy it into the
+  /// isolate's message, and from there it would have to be copied again,
+  /// because Dart heap memory can't be handed to a long running native call.
+  /// With the address only this single copy is left.
+  static int _moveToNative(Uint8List bytes) => _copyToNative(bytes).address;
+}
+
+/// Grid detection statistics since app start or the last reset.
+class DetectionStatistics {
+  final int detections;
+  final int successes;
+  final int thresholdPasses;
+
+  /// Successes per threshold setting, in the original priority order.
+  final List<int> settingSuccesses;
+
+  DetectionStatistics({
+    required this.detections,
+    required this.successes,
+    required this.thresholdPasses,
+    required this.settingSuccesses,
+  });
+
+  double get meanThresholdPasses =>
+      detections == 0 ? 0 : thresholdPasses / detections;
+}
+
+/// Where the digit classifier runs. The order matches the native BACKEND_*
+/// ids.
+enum InferenceBackend { cpu, xnnpack, nnapi }
+
+/// Backend the digit classifier runs on and how it got chosen.
+class BackendInfo {
+  final InferenceBackend backend;
+
+  /// CPU threads per interpreter, used by [InferenceBackend.cpu] and
+  /// [InferenceBackend.xnnpack].
+  final int threads;
+
+  /// Median time to classify a full grid per benchmarked backend. Empty if
+  /// the backend was given to [SudokuScanner.init] or stored by an earlier
+  /// launch. If [cached], these are the timings of the earlier benchmark the
+  /// choice was taken from.
+  final Map<InferenceBackend, Duration> benchmarks;
+
+  /// Chosen by an earlier benchmark in this process.
+  final bool cached;
+
+  BackendInfo({
+    required this.backend,
+    required this.threads,
+    required this.benchmarks,
+    required this.cached,
+  });
+
+  @override
+  String toString() {
+    final measured = benchmarks.entries
+        .map((e) => '${e.key.name} ${e.value.inMicroseconds} us')
+        .join(', ');
+    return 'BackendInfo(${backend.name}, $threads threads'
+        '${cached ? ', cached' : ''}${measured.isEmpty ? '' : ', $measured'})';
+  }
+}
+
+/// Usage of the native interpreter pool that classifies digits. Concurrent
+/// extractions only wait for each other if they outnumber the pool.
+class ClassifierStatistics {
+  final int poolSize;
+  final int checkouts;
+
+  /// Checkouts that found every interpreter busy.
+  final int contendedCheckouts;
+
+  /// Most interpreters in use at the same time.
+  final int peakInUse;
+
+  ClassifierStatistics({
+    required this.poolSize,
+    required this.checkouts,
+    required this.contendedCheckouts,
+    required this.peakInUse,
+  });
+
+  double get contention =>
+      checkouts == 0 ? 0 : contendedCheckouts / checkouts;
+}
+
+/// Stage timings and counters of the latest scan on the scanner context.
+/// Each native call only replaces the stages it ran, so after detection and
+/// extraction of the same image all stages belong to that scan.
+///
+/// All zero if the native library was built without scan statistics.
+class ScanStats {
+  final bool enabled;
+  final Duration decode;
+  final Duration preprocess;
+  final Duration locateGrid;
+  final Duration warp;
+  final Duration binarize;
+  final Duration removeGridLines;
+  final Duration extractCells;
+  final Duration predictNumbers;
+  final Duration correctNumbers;
+  final int thresholdPasses;
+
+  /// Four-cornered contours found during detection.
+  final int quadrilaterals;
+
+  /// Quadrilaterals rejected as not square enough.
+  final int rejectedQuadrilaterals;
+
+  /// Cells holding a digit.
+  final int cells;
+
+  /// Digits changed by the Sudoku rules.
+  final int correctedCells;
+
+  ScanStats({
+    required this.enabled,
+    required this.decode,
+    required this.preprocess,
+    required this.locateGrid,
+    required this.warp,
+    required this.binarize,
+    required this.removeGridLines,
+    required this.extractCells,
+    required this.predictNumbers,
+    required this.correctNumbers,
+    required this.thresholdPasses,
+    required this.quadrilaterals,
+    required this.rejectedQuadrilaterals,
+    required this.cells,
+    required this.correctedCells,
+  });
+
+  Duration get total =>
+      decode +
+      preprocess +
+      locateGrid +
+      warp +
+      binarize +
+      removeGridLines +
+      extractCells +
+      predictNumbers +
+      correctNumbers;
+
+  @override
+  String toString() {
+    if (!enabled) return 'ScanStats(disabled)';
+
+    String ms(Duration d) => (d.inMicroseconds / 1000).toStringAsFixed(1);
+
+    return 'ScanStats(total ${ms(total)} ms: '
+        'decode ${ms(decode)}, preprocess ${ms(preprocess)}, '
+        'locate ${ms(locateGrid)} ($thresholdPasses passes, '
+        '$rejectedQuadrilaterals/$quadrilaterals quads rejected), '
+        'warp ${ms(warp)}, binarize ${ms(binarize)}, '
+        'lines ${ms(removeGridLines)}, cells ${ms(extractCells)} ($cells), '
+        'predict ${ms(predictNumbers)}, '
+        'correct ${ms(correctNumbers)} ($correctedCells changed))';
+  }
+}
+
+/// Decoded image kept in native memory, see [SudokuScanner.openSession].
+///
+/// Calls on one session must not overlap.
+class ScanSession {
+  final int _address;
+  bool _isClosed = false;
+
+  ScanSession._(this._address);
+
+  Future<BoundingBox> detectGrid() async {
+    assert(!_isClosed);
+    final sessionAddress = _address;
+
+    final nativeboundingBoxAdress = await compute((_) {
+      // [DynamicLibrary] can't be passed through Isolate Ports, so we need to create new one
+      final bindings = SudokuScanner._getBindings();
+
+      final nativeBoundingBoxPointer = bindings.scan_detect(
+          Pointer<native.ScanSession>.fromAddress(sessionAddress));
+
+      return nativeBoundingBoxPointer.address;
+    }, null);
+
+    final nativeBoundingBoxPointer =
+        Pointer<native.BoundingBox>.fromAddress(nativeboundingBoxAdress);
+    final nbb = nativeBoundingBoxPointer.ref;
+    final bb = BoundingBox(
+      topLeft: Offset(nbb.top_left.x, nbb.top_left.y),
+      topRight: Offset(nbb.top_right.x, nbb.top_right.y),
+      bottomLeft: Offset(nbb.bottom_left.x, nbb.bottom_left.y),
+      bottomRight: Offset(nbb.bottom_right.x, nbb.bottom_right.y),
+    );
+
+    SudokuScanner._freePointer(nativeBoundingBoxPointer);
+
+    return bb;
+  }
+
+  Future<Uint8List> extractGrid(BoundingBox boundingBox) async {
+    assert(!_isClosed);
+    final sessionAddress = _address;
+
+    final gridArrayAddress = await compute((_) {
+      // [DynamicLibrary] can't be passed through Isolate Ports, so we need to create new one
+      final bindings = SudokuScanner._getBindings();
+
+      final nativeBoundingBoxPointer = malloc<native.BoundingBox>();
+
+      nativeBoundingBoxPointer.ref
+        ..top_left.x = boundingBox.topLeft.dx
+        ..top_left.y = boundingBox.topLeft.dy
+        ..top_right.x = boundingBox.topRight.dx
+        ..top_right.y = boundingBox.topRight.dy
+        ..bottom_left.x = boundingBox.bottomLeft.dx
+        ..bottom_left.y = boundingBox.bottomLeft.dy
+        ..bottom_right.x = boundingBox.bottomRight.dx
+        ..bottom_right.y = boundingBox.bottomRight.dy;
+
+      Pointer<Uint8> gridArray = bindings.scan_extract(
+          Pointer<native.ScanSession>.fromAddress(sessionAddress),
+          nativeBoundingBoxPointer);
+
+      malloc.free(nativeBoundingBoxPointer);
+
+      return gridArray.address;
+    }, null);
+
+    final gridArray = Pointer<Uint8>.fromAddress(gridArrayAddress);
+
+    final gridList = gridArray.asTypedList(81,
+        finalizer: SudokuScanner._bindings.free_pointerPtr);
+
+    return gridList;
+  }
+
+  /// See [SudokuScanner.extractGridDetails].
+  Future<List<CellResult>?> extractGridDetails(BoundingBox boundingBox) async {
+    assert(!_isClosed);
+    final sessionAddress = _address;
+
+    final resultAddress = await compute((_) {
+      // [DynamicLibrary] can't be passed through Isolate Ports, so we need to create new one
+      final bindings = SudokuScanner._getBindings();
+
+      final nativeBoundingBoxPointer = malloc<native.BoundingBox>();
+      final resultPointer = malloc<native.GridResult>();
+
+      nativeBoundingBoxPointer.ref
+        ..top_left.x = boundingBox.topLeft.dx
+        ..top_left.y = boundingBox.topLeft.dy
+        ..top_right.x = boundingBox.topRight.dx
+        ..top_right.y = boundingBox.topRight.dy
+        ..bottom_left.x = boundingBox.bottomLeft.dx
+        ..bottom_left.y = boundingBox.bottomLeft.dy
+        ..bottom_right.x = boundingBox.bottomRight.dx
+        ..bottom_right.y = boundingBox.bottomRight.dy;
+
+      final success = bindings.scan_extract_details(
+          Pointer<native.ScanSession>.fromAddress(sessionAddress),
+          nativeBoundingBoxPointer,
+          resultPointer);
+
+      malloc.free(nativeBoundingBoxPointer);
+
+      if (!success) {
+        malloc.free(resultPointer);
+        return 0;
+      }
+
+      return resultPointer.address;
+    }, null);
+
+    return SudokuScanner._readGridResult(resultAddress);
+  }
+
+  /// Frees the native image. The session can't be used afterwards.
+  void close() {
+    if (_isClosed) return;
+    _isClosed = true;
+
+    SudokuScanner._bindings
+        .scan_close(Pointer<native.ScanSession>.fromAddress(_address));
+  }
+}
+
+/// Follows a grid through the frames of the camera image stream.
+///
+/// Tracking a grid from one frame to the next is much cheaper than detecting
+/// it again, so [track] is meant to be called for every preview frame. It
+/// runs on a background isolate, because a frame without a tracked grid
+/// costs a full detection.
+class GridTracking {
+  final Pointer<native.TrackingSession> _session;
+  bool _isClosed = false;
+
+  /// Frame still being tracked, null when idle.
+  Future<BoundingBox?>? _pending;
+  BoundingBox? _latest;
+  bool _resetRequested = false;
+
+  GridTracking()
+      : _session =
+            SudokuScanner._bindings.track_open(SudokuScanner._context);
+
+  /// Whether a frame is still being tracked.
+  bool get isBusy => _pending != null;
+
+  /// Completes with the bounding box of the grid in [frame] or null if there
+  /// is none.
+  ///
+  /// While an earlier frame is still being tracked, [frame] is skipped and
+  /// the call completes right away with the latest result, so preview frames
+  /// coming in faster than they can be tracked are dropped instead of queued.
+  Future<BoundingBox?> track(CameraFrame frame) {
+    assert(!_isClosed);
+
+    if (isBusy) return Future.value(_latest);
+
+    final sessionAddress = _session.address;
+    final frameAddress = SudokuScanner._moveFrameToNative(frame);
+
+    final tracking = compute((_) {
+      // [DynamicLibrary] can't be passed through Isolate Ports, so we need to create new one
+      final bindings = SudokuScanner._getBindings();
+
+      final nativeFramePointer =
+          Pointer<native.YuvFrame>.fromAddress(frameAddress);
+      final nativeBoundingBoxPointer = malloc<native.BoundingBox>();
+
+      final result = bindings.track_frame(
+          Pointer<native.TrackingSession>.fromAddress(sessionAddress),
+          nativeFramePointer,
+          nativeBoundingBoxPointer);
+
+      SudokuScanner._freeFrame(nativeFramePointer);
+
+      if (result == native.TRACK_NONE) {
+        malloc.free(nativeBoundingBoxPointer);
+        return 0;
+      }
+
+      return nativeBoundingBoxPointer.address;
+    }, null).then((nativeBoundingBoxAddress) {
+      if (nativeBoundingBoxAddress == 0) return null;
+
+      final nativeBoundingBoxPointer =
+          Pointer<native.BoundingBox>.fromAddress(nativeBoundingBoxAddress);
+      final nbb = nativeBoundingBoxPointer.ref;
+      final bb = BoundingBox(
+        topLeft: Offset(nbb.top_left.x, nbb.top_left.y),
+        topRight: Offset(nbb.top_right.x, nbb.top_right.y),
+        bottomLeft: Offset(nbb.bottom_left.x, nbb.bottom_left.y),
+        bottomRight: Offset(nbb.bottom_right.x, nbb.bottom_right.y),
+      );
+
+      malloc.free(nativeBoundingBoxPointer);
+
+      return bb;
+    }).then((bb) => _latest = bb).whenComplete(_finishFrame);
+
+    _pending = tracking;
+    return tracking;
+  }
+
+  /// Applies what had to wait for the running frame.
+  void _finishFrame() {
+    _pending = null;
+
+    if (_isClosed) {
+      SudokuScanner._bindings.track_close(_session);
+    } else if (_resetRequested) {
+      _resetRequested = false;
+      SudokuScanner._bindings.track_reset(_session);
+    }
+  }
+
+  /// Forgets the current grid, the next frame runs a full detection.
+  void reset() {
+    assert(!_isClosed);
+    _latest = null;
+
+    // the session must not change under a running frame
+    if (isBusy) {
+      _resetRequested = true;
+    } else {
+      SudokuScanner._bindings.track_reset(_session);
+    }
+  }
+
+  /// Frees the session, once the running frame is done if there is one.
+  void close() {
+    if (_isClosed) return;
+    _isClosed = true;
+
+    if (!isBusy) {
+      SudokuScanner._bindings.track_close(_session);
+    }
+  }
 }
@@ -27,26 +27,113 @@ class SudokuScannerBindings {
           lookup)
       : _lookup = lookup;
 
+  /// A scanner context owns the classifier model plus the detection tuning and
+  /// statistics, every scan runs on one. Scans on the same or on different
+  /// contexts may run concurrently from any thread, the model is shared by a
+  /// pool of interpreters (one per core, at most 4) so concurrent scans
+  /// classify in parallel. The model runs on backend (one of BACKEND_*), or
+  /// on CPU if that is not available here. Apps can store the backend that
+  /// BACKEND_AUTO picked (see get_backend_info) and pass it on later launches
+  /// to skip the benchmark. Returns null if the model could not be loaded.
+  ffi.Pointer<ScannerContext> scanner_create(
+    ffi.Pointer<ffi.Char> model_path,
+    int backend,
+  ) {
+    return _scanner_create(
+      model_path,
+      backend,
+    );
+  }
+
+  late final _scanner_createPtr = _lookup<
+      ffi.NativeFunction<
+          ffi.Pointer<ScannerContext> Function(ffi.Pointer<ffi.Char>, ffi.Int32)>>('scanner_create');
+  late final _scanner_create = _scanner_createPtr.asFunction<
+      ffi.Pointer<ScannerContext> Function(ffi.Pointer<ffi.Char>, int)>();
+
+  /// Same as scanner_create, but takes the model file (e.g. straight from the
+  /// app's assets) from memory. The bytes are copied, so they can be freed
+  /// right after the call.
+  ffi.Pointer<ScannerContext> scanner_create_from_buffer(
+    ffi.Pointer<ffi.Uint8> model_data,
+    int size,
+    int backend,
+  ) {
+    return _scanner_create_from_buffer(
+      model_data,
+      size,
+      backend,
+    );
+  }
+
+  late final _scanner_create_from_bufferPtr = _lookup<
+      ffi.NativeFunction<
+          ffi.Pointer<ScannerContext> Function(ffi.Pointer<ffi.Uint8>,
+              ffi.Int32, ffi.Int32)>>('scanner_create_from_buffer');
+  late final _scanner_create_from_buffer = _scanner_create_from_bufferPtr.asFunction<
+      ffi.Pointer<ScannerContext> Function(ffi.Pointer<ffi.Uint8>, int, int)>();
+
+  /// Runs the classifier on blank input with every interpreter of the pool and
+  /// the whole pipeline once on a synthetic grid, so the first real scan does
+  /// not pay for delegate preparation, tensor allocation and lazy library
+  /// initialization. Blocks until done, meant to be called from a background
+  /// thread right after scanner_create. Scans may run meanwhile. Detection
+  /// statistics and tuning of the context are not affected. Returns false if
+  /// inference failed.
+  bool scanner_warmup(
+    ffi.Pointer<ScannerContext> context,
+  ) {
+    return _scanner_warmup(
+      context,
+    );
+  }
+
+  late final _scanner_warmupPtr = _lookup<
+      ffi.NativeFunction<
+          ffi.Bool Function(ffi.Pointer<ScannerContext>)>>('scanner_warmup');
+  late final _scanner_warmup = _scanner_warmupPtr.asFunction<
+      bool Function(ffi.Pointer<ScannerContext>)>();
+
+  /// Sessions opened on the context must be closed and no scan may be running.
+  void scanner_destroy(
+    ffi.Pointer<ScannerContext> context,
+  ) {
+    return _scanner_destroy(
+      context,
+    );
+  }
+
+  late final _scanner_destroyPtr = _lookup<
+      ffi.NativeFunction<
+          ffi.Void Function(ffi.Pointer<ScannerContext>)>>('scanner_destroy');
+  late final _scanner_destroy = _scanner_destroyPtr.asFunction<
+      void Function(ffi.Pointer<ScannerContext>)>();
+
   ffi.Pointer<BoundingBox> detect_grid(
+    ffi.Pointer<ScannerContext> context,
     ffi.Pointer<ffi.Char> path,
   ) {
     return _detect_grid(
+      context,
       path,
     );
   }
 
   late final _detect_gridPtr = _lookup<
       ffi.NativeFunction<
-          ffi.Pointer<BoundingBox> Function(
+          ffi.Pointer<BoundingBox> Function(ffi.Pointer<ScannerContext>,
               ffi.Pointer<ffi.Char>)>>('detect_grid');
-  late final _detect_grid = _detect_gridPtr
-      .asFunction<ffi.Pointer<BoundingBox> Function(ffi.Pointer<ffi.Char>)>();
+  late final _detect_grid = _detect_gridPtr.asFunction<
+      ffi.Pointer<BoundingBox> Function(ffi.Pointer<ScannerContext>,
+          ffi.Pointer<ffi.Char>)>();
 
   ffi.Pointer<ffi.Uint8> extract_grid(
+    ffi.Pointer<ScannerContext> context,
     ffi.Pointer<ffi.Char> path,
     ffi.Pointer<BoundingBox> bounding_box,
   ) {
     return _extract_grid(
+      context,
       path,
       bounding_box,
     );
@@ -54,18 +141,20 @@ class SudokuScannerBindings {
 
   late final _extract_gridPtr = _lookup<
       ffi.NativeFunction<
-          ffi.Pointer<ffi.Uint8> Function(ffi.Pointer<ffi.Char>,
-              ffi.Pointer<BoundingBox>)>>('extract_grid');
+          ffi.Pointer<ffi.Uint8> Function(ffi.Pointer<ScannerContext>,
+              ffi.Pointer<ffi.Char>, ffi.Pointer<BoundingBox>)>>('extract_grid');
   late final _extract_grid = _extract_gridPtr.asFunction<
-      ffi.Pointer<ffi.Uint8> Function(
+      ffi.Pointer<ffi.Uint8> Function(ffi.Pointer<ScannerContext>,
           ffi.Pointer<ffi.Char>, ffi.Pointer<BoundingBox>)>();
 
   ffi.Pointer<ffi.Uint8> extract_grid_from_roi(
+    ffi.Pointer<ScannerContext> context,
     ffi.Pointer<ffi.Char> path,
     int roi_size,
     int roi_offset,
   ) {
     return _extract_grid_from_roi(
+      context,
       path,
       roi_size,
       roi_offset,
@@ -74,24 +163,491 @@ class SudokuScannerBindings {
 
   late final _extract_grid_from_roiPtr = _lookup<
       ffi.NativeFunction<
-          ffi.Pointer<ffi.Uint8> Function(ffi.Pointer<ffi.Char>, ffi.Int32,
-              ffi.Int32)>>('extract_grid_from_roi');
+          ffi.Pointer<ffi.Uint8> Function(ffi.Pointer<ScannerContext>,
+              ffi.Pointer<ffi.Char>, ffi.Int32, ffi.Int32)>>('extract_grid_from_roi');
   late final _extract_grid_from_roi = _extract_grid_from_roiPtr.asFunction<
-      ffi.Pointer<ffi.Uint8> Function(ffi.Pointer<ffi.Char>, int, int)>();
+      ffi.Pointer<ffi.Uint8> Function(ffi.Pointer<ScannerContext>,
+          ffi.Pointer<ffi.Char>, int, int)>();
 
-  void set_model(
+  /// Same as extract_grid, but writes the details of every cell into the given
+  /// memory instead of allocating. Returns false if the image could not be read.
+  bool extract_grid_details(
+    ffi.Pointer<ScannerContext> context,
     ffi.Pointer<ffi.Char> path,
+    ffi.Pointer<BoundingBox> bounding_box,
+    ffi.Pointer<GridResult> result,
   ) {
-    return _set_model(
+    return _extract_grid_details(
+      context,
       path,
+      bounding_box,
+      result,
+    );
+  }
+
+  late final _extract_grid_detailsPtr = _lookup<
+      ffi.NativeFunction<
+          ffi.Bool Function(ffi.Pointer<ScannerContext>, ffi.Pointer<ffi.Char>,
+              ffi.Pointer<BoundingBox>, ffi.Pointer<GridResult>)>>('extract_grid_details');
+  late final _extract_grid_details = _extract_grid_detailsPtr.asFunction<
+      bool Function(ffi.Pointer<ScannerContext>, ffi.Pointer<ffi.Char>,
+          ffi.Pointer<BoundingBox>, ffi.Pointer<GridResult>)>();
+
+  /// Variants of the above taking an encoded image (e.g. JPEG) from memory.
+  /// The buffer is only read during the call and is not copied.
+  ffi.Pointer<BoundingBox> detect_grid_from_bytes(
+    ffi.Pointer<ScannerContext> context,
+    ffi.Pointer<ffi.Uint8> data,
+    int size,
+  ) {
+    return _detect_grid_from_bytes(
+      context,
+      data,
+      size,
+    );
+  }
+
+  late final _detect_grid_from_bytesPtr = _lookup<
+      ffi.NativeFunction<
+          ffi.Pointer<BoundingBox> Function(ffi.Pointer<ScannerContext>,
+              ffi.Pointer<ffi.Uint8>, ffi.Int32)>>('detect_grid_from_bytes');
+  late final _detect_grid_from_bytes = _detect_grid_from_bytesPtr.asFunction<
+      ffi.Pointer<BoundingBox> Function(ffi.Pointer<ScannerContext>,
+          ffi.Pointer<ffi.Uint8>, int)>();
+
+  ffi.Pointer<ffi.Uint8> extract_grid_from_bytes(
+    ffi.Pointer<ScannerContext> context,
+    ffi.Pointer<ffi.Uint8> data,
+    int size,
+    ffi.Pointer<BoundingBox> bounding_box,
+  ) {
+    return _extract_grid_from_bytes(
+      context,
+      data,
+      size,
+      bounding_box,
+    );
+  }
+
+  late final _extract_grid_from_bytesPtr = _lookup<
+      ffi.NativeFunction<
+          ffi.Pointer<ffi.Uint8> Function(ffi.Pointer<ScannerContext>,
+              ffi.Pointer<ffi.Uint8>, ffi.Int32, ffi.Pointer<BoundingBox>)>>('extract_grid_from_bytes');
+  late final _extract_grid_from_bytes = _extract_grid_from_bytesPtr.asFunction<
+      ffi.Pointer<ffi.Uint8> Function(ffi.Pointer<ScannerContext>,
+          ffi.Pointer<ffi.Uint8>, int, ffi.Pointer<BoundingBox>)>();
+
+  ffi.Pointer<ffi.Uint8> extract_grid_from_roi_bytes(
+    ffi.Pointer<ScannerContext> context,
+    ffi.Pointer<ffi.Uint8> data,
+    int size,
+    int roi_size,
+    int roi_offset,
+  ) {
+    return _extract_grid_from_roi_bytes(
+      context,
+      data,
+      size,
+      roi_size,
+      roi_offset,
+    );
+  }
+
+  late final _extract_grid_from_roi_bytesPtr = _lookup<
+      ffi.NativeFunction<
+          ffi.Pointer<ffi.Uint8> Function(ffi.Pointer<ScannerContext>,
+              ffi.Pointer<ffi.Uint8>, ffi.Int32, ffi.Int32, ffi.Int32)>>('extract_grid_from_roi_bytes');
+  late final _extract_grid_from_roi_bytes = _extract_grid_from_roi_bytesPtr.asFunction<
+      ffi.Pointer<ffi.Uint8> Function(ffi.Pointer<ScannerContext>,
+          ffi.Pointer<ffi.Uint8>, int, int, int)>();
+
+  /// Variants taking a raw camera frame, e.g. from the preview image stream.
+  /// The frame is only read during the call and is not copied unless rotated.
+  ffi.Pointer<BoundingBox> detect_grid_from_frame(
+    ffi.Pointer<ScannerContext> context,
+    ffi.Pointer<YuvFrame> frame,
+  ) {
+    return _detect_grid_from_frame(
+      context,
+      frame,
+    );
+  }
+
+  late final _detect_grid_from_framePtr = _lookup<
+      ffi.NativeFunction<
+          ffi.Pointer<BoundingBox> Function(ffi.Pointer<ScannerContext>,
+              ffi.Pointer<YuvFrame>)>>('detect_grid_from_frame');
+  late final _detect_grid_from_frame = _detect_grid_from_framePtr.asFunction<
+      ffi.Pointer<BoundingBox> Function(ffi.Pointer<ScannerContext>,
+          ffi.Pointer<YuvFrame>)>();
+
+  ffi.Pointer<ffi.Uint8> extract_grid_from_frame(
+    ffi.Pointer<ScannerContext> context,
+    ffi.Pointer<YuvFrame> frame,
+    ffi.Pointer<BoundingBox> bounding_box,
+  ) {
+    return _extract_grid_from_frame(
+      context,
+      frame,
+      bounding_box,
+    );
+  }
+
+  late final _extract_grid_from_framePtr = _lookup<
+      ffi.NativeFunction<
+          ffi.Pointer<ffi.Uint8> Function(ffi.Pointer<ScannerContext>,
+              ffi.Pointer<YuvFrame>, ffi.Pointer<BoundingBox>)>>('extract_grid_from_frame');
+  late final _extract_grid_from_frame = _extract_grid_from_framePtr.asFunction<
+      ffi.Pointer<ffi.Uint8> Function(ffi.Pointer<ScannerContext>,
+          ffi.Pointer<YuvFrame>, ffi.Pointer<BoundingBox>)>();
+
+  ffi.Pointer<ffi.Uint8> extract_grid_from_roi_frame(
+    ffi.Pointer<ScannerContext> context,
+    ffi.Pointer<YuvFrame> frame,
+    int roi_size,
+    int roi_offset,
+  ) {
+    return _extract_grid_from_roi_frame(
+      context,
+      frame,
+      roi_size,
+      roi_offset,
+    );
+  }
+
+  late final _extract_grid_from_roi_framePtr = _lookup<
+      ffi.NativeFunction<
+          ffi.Pointer<ffi.Uint8> Function(ffi.Pointer<ScannerContext>,
+              ffi.Pointer<YuvFrame>, ffi.Int32, ffi.Int32)>>('extract_grid_from_roi_frame');
+  late final _extract_grid_from_roi_frame = _extract_grid_from_roi_framePtr.asFunction<
+      ffi.Pointer<ffi.Uint8> Function(ffi.Pointer<ScannerContext>,
+          ffi.Pointer<YuvFrame>, int, int)>();
+
+  ffi.Pointer<ScanSession> scan_open(
+    ffi.Pointer<ScannerContext> context,
+    ffi.Pointer<ffi.Char> path,
+  ) {
+    return _scan_open(
+      context,
+      path,
+    );
+  }
+
+  late final _scan_openPtr = _lookup<
+      ffi.NativeFunction<
+          ffi.Pointer<ScanSession> Function(ffi.Pointer<ScannerContext>,
+              ffi.Pointer<ffi.Char>)>>('scan_open');
+  late final _scan_open = _scan_openPtr.asFunction<
+      ffi.Pointer<ScanSession> Function(ffi.Pointer<ScannerContext>,
+          ffi.Pointer<ffi.Char>)>();
+
+  ffi.Pointer<ScanSession> scan_open_from_bytes(
+    ffi.Pointer<ScannerContext> context,
+    ffi.Pointer<ffi.Uint8> data,
+    int size,
+  ) {
+    return _scan_open_from_bytes(
+      context,
+      data,
+      size,
+    );
+  }
+
+  late final _scan_open_from_bytesPtr = _lookup<
+      ffi.NativeFunction<
+          ffi.Pointer<ScanSession> Function(ffi.Pointer<ScannerContext>,
+              ffi.Pointer<ffi.Uint8>, ffi.Int32)>>('scan_open_from_bytes');
+  late final _scan_open_from_bytes = _scan_open_from_bytesPtr.asFunction<
+      ffi.Pointer<ScanSession> Function(ffi.Pointer<ScannerContext>,
+          ffi.Pointer<ffi.Uint8>, int)>();
+
+  ffi.Pointer<BoundingBox> scan_detect(
+    ffi.Pointer<ScanSession> session,
+  ) {
+    return _scan_detect(
+      session,
+    );
+  }
+
+  late final _scan_detectPtr = _lookup<
+      ffi.NativeFunction<
+          ffi.Pointer<BoundingBox> Function(
+              ffi.Pointer<ScanSession>)>>('scan_detect');
+  late final _scan_detect = _scan_detectPtr
+      .asFunction<ffi.Pointer<BoundingBox> Function(ffi.Pointer<ScanSession>)>();
+
+  ffi.Pointer<ffi.Uint8> scan_extract(
+    ffi.Pointer<ScanSession> session,
+    ffi.Pointer<BoundingBox> bounding_box,
+  ) {
+    return _scan_extract(
+      session,
+      bounding_box,
+    );
+  }
+
+  late final _scan_extractPtr = _lookup<
+      ffi.NativeFunction<
+          ffi.Pointer<ffi.Uint8> Function(ffi.Pointer<ScanSession>,
+              ffi.Pointer<BoundingBox>)>>('scan_extract');
+  late final _scan_extract = _scan_extractPtr.asFunction<
+      ffi.Pointer<ffi.Uint8> Function(
+          ffi.Pointer<ScanSession>, ffi.Pointer<BoundingBox>)>();
+
+  bool scan_extract_details(
+    ffi.Pointer<ScanSession> session,
+    ffi.Pointer<BoundingBox> bounding_box,
+    ffi.Pointer<GridResult> result,
+  ) {
+    return _scan_extract_details(
+      session,
+      bounding_box,
+      result,
+    );
+  }
+
+  late final _scan_extract_detailsPtr = _lookup<
+      ffi.NativeFunction<
+          ffi.Bool Function(ffi.Pointer<ScanSession>, ffi.Pointer<BoundingBox>,
+              ffi.Pointer<GridResult>)>>('scan_extract_details');
+  late final _scan_extract_details = _scan_extract_detailsPtr.asFunction<
+      bool Function(ffi.Pointer<ScanSession>, ffi.Pointer<BoundingBox>,
+          ffi.Pointer<GridResult>)>();
+
+  void scan_close(
+    ffi.Pointer<ScanSession> session,
+  ) {
+    return _scan_close(
+      session,
+    );
+  }
+
+  late final _scan_closePtr =
+      _lookup<ffi.NativeFunction<ffi.Void Function(ffi.Pointer<ScanSession>)>>(
+          'scan_close');
+  late final _scan_close =
+      _scan_closePtr.asFunction<void Function(ffi.Pointer<ScanSession>)>();
+
+  ffi.Pointer<TrackingSession> track_open(
+    ffi.Pointer<ScannerContext> context,
+  ) {
+    return _track_open(
+      context,
+    );
+  }
+
+  late final _track_openPtr = _lookup<
+      ffi.NativeFunction<
+          ffi.Pointer<TrackingSession> Function(ffi.Pointer<ScannerContext>)>>('track_open');
+  late final _track_open = _track_openPtr.asFunction<
+      ffi.Pointer<TrackingSession> Function(ffi.Pointer<ScannerContext>)>();
+
+  int track_frame(
+    ffi.Pointer<TrackingSession> session,
+    ffi.Pointer<YuvFrame> frame,
+    ffi.Pointer<BoundingBox> bounding_box,
+  ) {
+    return _track_frame(
+      session,
+      frame,
+      bounding_box,
+    );
+  }
+
+  late final _track_framePtr = _lookup<
+      ffi.NativeFunction<
+          ffi.Int32 Function(ffi.Pointer<TrackingSession>, ffi.Pointer<YuvFrame>,
+              ffi.Pointer<BoundingBox>)>>('track_frame');
+  late final _track_frame = _track_framePtr.asFunction<
+      int Function(ffi.Pointer<TrackingSession>, ffi.Pointer<YuvFrame>,
+          ffi.Pointer<BoundingBox>)>();
+
+  void track_reset(
+    ffi.Pointer<TrackingSession> session,
+  ) {
+    return _track_reset(
+      session,
+    );
+  }
+
+  late final _track_resetPtr = _lookup<
+          ffi.NativeFunction<ffi.Void Function(ffi.Pointer<TrackingSession>)>>(
+      'track_reset');
+  late final _track_reset =
+      _track_resetPtr.asFunction<void Function(ffi.Pointer<TrackingSession>)>();
+
+  void track_close(
+    ffi.Pointer<TrackingSession> session,
+  ) {
+    return _track_close(
+      session,
+    );
+  }
+
+  late final _track_closePtr = _lookup<
+          ffi.NativeFunction<ffi.Void Function(ffi.Pointer<TrackingSession>)>>(
+      'track_close');
+  late final _track_close =
+      _track_closePtr.asFunction<void Function(ffi.Pointer<TrackingSession>)>();
+
+  /// Solves the 81 values of grid (row-major, 0 for empty cells) and writes the
+  /// solution into the 81 bytes of solution. Returns false if the grid
+  /// contradicts itself or has no solution. Both may point to the same memory.
+  bool solve_grid(
+    ffi.Pointer<ffi.Uint8> grid,
+    ffi.Pointer<ffi.Uint8> solution,
+  ) {
+    return _solve_grid(
+      grid,
+      solution,
+    );
+  }
+
+  late final _solve_gridPtr = _lookup<
+      ffi.NativeFunction<
+          ffi.Bool Function(
+              ffi.Pointer<ffi.Uint8>, ffi.Pointer<ffi.Uint8>)>>('solve_grid');
+  late final _solve_grid = _solve_gridPtr.asFunction<
+      bool Function(ffi.Pointer<ffi.Uint8>, ffi.Pointer<ffi.Uint8>)>();
+
+  /// Counts the solutions of grid, but stops at limit. A limit of 2 tells
+  /// whether a scanned grid is a proper Sudoku (exactly one solution), has
+  /// none (e.g. a misread digit) or several (e.g. a missed digit).
+  int count_solutions(
+    ffi.Pointer<ffi.Uint8> grid,
+    int limit,
+  ) {
+    return _count_solutions(
+      grid,
+      limit,
+    );
+  }
+
+  late final _count_solutionsPtr = _lookup<
+          ffi.NativeFunction<ffi.Int32 Function(ffi.Pointer<ffi.Uint8>, ffi.Int32)>>(
+      'count_solutions');
+  late final _count_solutions = _count_solutionsPtr
+      .asFunction<int Function(ffi.Pointer<ffi.Uint8>, int)>();
+
+  /// Lets detection evaluate all threshold settings in parallel. Lowers worst
+  /// case latency on multi-core devices at the cost of more total work.
+  void set_parallel_detection(
+    ffi.Pointer<ScannerContext> context,
+    bool enabled,
+  ) {
+    return _set_parallel_detection(
+      context,
+      enabled,
+    );
+  }
+
+  late final _set_parallel_detectionPtr = _lookup<
+      ffi.NativeFunction<
+          ffi.Void Function(ffi.Pointer<ScannerContext>, ffi.Bool)>>('set_parallel_detection');
+  late final _set_parallel_detection = _set_parallel_detectionPtr.asFunction<
+      void Function(ffi.Pointer<ScannerContext>, bool)>();
+
+  /// Lets detection try the threshold settings that succeeded most often for
+  /// similar lighting (brightness and contrast) first.
+  void set_adaptive_detection(
+    ffi.Pointer<ScannerContext> context,
+    bool enabled,
+  ) {
+    return _set_adaptive_detection(
+      context,
+      enabled,
     );
   }
 
-  late final _set_modelPtr =
-      _lookup<ffi.NativeFunction<ffi.Void Function(ffi.Pointer<ffi.Char>)>>(
-          'set_model');
-  late final _set_model =
-      _set_modelPtr.asFunction<void Function(ffi.Pointer<ffi.Char>)>();
+  late final _set_adaptive_detectionPtr = _lookup<
+      ffi.NativeFunction<
+          ffi.Void Function(ffi.Pointer<ScannerContext>, ffi.Bool)>>('set_adaptive_detection');
+  late final _set_adaptive_detection = _set_adaptive_detectionPtr.asFunction<
+      void Function(ffi.Pointer<ScannerContext>, bool)>();
+
+  void get_detection_statistics(
+    ffi.Pointer<ScannerContext> context,
+    ffi.Pointer<DetectionStatistics> statistics,
+  ) {
+    return _get_detection_statistics(
+      context,
+      statistics,
+    );
+  }
+
+  late final _get_detection_statisticsPtr = _lookup<
+      ffi.NativeFunction<
+          ffi.Void Function(ffi.Pointer<ScannerContext>,
+              ffi.Pointer<DetectionStatistics>)>>('get_detection_statistics');
+  late final _get_detection_statistics = _get_detection_statisticsPtr.asFunction<
+      void Function(ffi.Pointer<ScannerContext>,
+          ffi.Pointer<DetectionStatistics>)>();
+
+  void reset_detection_statistics(
+    ffi.Pointer<ScannerContext> context,
+  ) {
+    return _reset_detection_statistics(
+      context,
+    );
+  }
+
+  late final _reset_detection_statisticsPtr = _lookup<
+      ffi.NativeFunction<
+          ffi.Void Function(ffi.Pointer<ScannerContext>)>>('reset_detection_statistics');
+  late final _reset_detection_statistics = _reset_detection_statisticsPtr.asFunction<
+      void Function(ffi.Pointer<ScannerContext>)>();
+
+  void get_backend_info(
+    ffi.Pointer<ScannerContext> context,
+    ffi.Pointer<BackendInfo> info,
+  ) {
+    return _get_backend_info(
+      context,
+      info,
+    );
+  }
+
+  late final _get_backend_infoPtr = _lookup<
+      ffi.NativeFunction<
+          ffi.Void Function(ffi.Pointer<ScannerContext>,
+              ffi.Pointer<BackendInfo>)>>('get_backend_info');
+  late final _get_backend_info = _get_backend_infoPtr.asFunction<
+      void Function(ffi.Pointer<ScannerContext>, ffi.Pointer<BackendInfo>)>();
+
+  void get_classifier_statistics(
+    ffi.Pointer<ScannerContext> context,
+    ffi.Pointer<ClassifierStatistics> statistics,
+  ) {
+    return _get_classifier_statistics(
+      context,
+      statistics,
+    );
+  }
+
+  late final _get_classifier_statisticsPtr = _lookup<
+      ffi.NativeFunction<
+          ffi.Void Function(ffi.Pointer<ScannerContext>,
+              ffi.Pointer<ClassifierStatistics>)>>('get_classifier_statistics');
+  late final _get_classifier_statistics = _get_classifier_statisticsPtr.asFunction<
+      void Function(ffi.Pointer<ScannerContext>,
+          ffi.Pointer<ClassifierStatistics>)>();
+
+  void get_scan_stats(
+    ffi.Pointer<ScannerContext> context,
+    ffi.Pointer<ScanStats> stats,
+  ) {
+    return _get_scan_stats(
+      context,
+      stats,
+    );
+  }
+
+  late final _get_scan_statsPtr = _lookup<
+      ffi.NativeFunction<
+          ffi.Void Function(ffi.Pointer<ScannerContext>,
+              ffi.Pointer<ScanStats>)>>('get_scan_stats');
+  late final _get_scan_stats = _get_scan_statsPtr.asFunction<
+      void Function(ffi.Pointer<ScannerContext>, ffi.Pointer<ScanStats>)>();
 
   void free_pointer(
     ffi.Pointer<ffi.Void> pointer,
@@ -125,3 +681,206 @@ final class BoundingBox extends ffi.Struct {
 
   external Offset bottom_right;
 }
+
+/// Collected over all grid detections since the last reset.
+final class DetectionStatistics extends ffi.Struct {
+  @ffi.Uint32()
+  external int detections;
+
+  @ffi.Uint32()
+  external int successes;
+
+  /// mean passes per detection is threshold_passes / detections
+  @ffi.Uint32()
+  external int threshold_passes;
+
+  /// successes per threshold setting, in original priority order
+  @ffi.Array.multi([5])
+  external ffi.Array<ffi.Uint32> setting_successes;
+}
+
+/// Backend a context classifies with and how it got chosen.
+final class BackendInfo extends ffi.Struct {
+  @ffi.Int32()
+  external int backend;
+
+  /// cpu threads per interpreter, used by BACKEND_CPU and BACKEND_XNNPACK
+  @ffi.Int32()
+  external int threads;
+
+  /// median full grid inference per backend (microseconds), 0 if
+  /// unavailable or not measured; from the earlier benchmark if cached
+  @ffi.Array.multi([3])
+  external ffi.Array<ffi.Uint32> benchmark_us;
+
+  /// taken from an earlier benchmark in this process
+  @ffi.Bool()
+  external bool cached;
+
+  /// FNV-1a hash of the model flatbuffer, tells whether a stored choice was
+  /// made for the same model
+  @ffi.Uint64()
+  external int model_hash;
+}
+
+/// Usage of the classifier's interpreter pool since the context was created.
+/// Classification waits only if more scans run at once than the pool has
+/// interpreters, which shows in contended_checkouts.
+final class ClassifierStatistics extends ffi.Struct {
+  @ffi.Uint32()
+  external int pool_size;
+
+  @ffi.Uint32()
+  external int checkouts;
+
+  @ffi.Uint32()
+  external int contended_checkouts;
+
+  /// most interpreters in use at the same time
+  @ffi.Uint32()
+  external int peak_in_use;
+}
+
+/// Stage timings (microseconds) and counters of the latest scan on a context.
+/// Every call only replaces the stages it ran, so after scan_detect and scan_extract the
+/// whole scan is covered. All 0 if the library was built without SCAN_STATS.
+final class ScanStats extends ffi.Struct {
+  @ffi.Uint32()
+  external int decode_us;
+
+  @ffi.Uint32()
+  external int preprocess_us;
+
+  @ffi.Uint32()
+  external int locate_grid_us;
+
+  @ffi.Uint32()
+  external int warp_us;
+
+  @ffi.Uint32()
+  external int binarize_us;
+
+  @ffi.Uint32()
+  external int remove_grid_lines_us;
+
+  @ffi.Uint32()
+  external int extract_cells_us;
+
+  @ffi.Uint32()
+  external int predict_numbers_us;
+
+  @ffi.Uint32()
+  external int correct_numbers_us;
+
+  @ffi.Uint32()
+  external int threshold_passes;
+
+  /// four-cornered contours found during detection and how many of them
+  /// were rejected as not square enough
+  @ffi.Uint32()
+  external int quadrilaterals;
+
+  @ffi.Uint32()
+  external int rejected_quadrilaterals;
+
+  /// cells holding a digit and digits changed by the Sudoku rules
+  @ffi.Uint32()
+  external int cells;
+
+  @ffi.Uint32()
+  external int corrected_cells;
+
+  @ffi.Bool()
+  external bool enabled;
+}
+
+/// Everything extraction knows about one cell.
+final class CellResult extends ffi.Struct {
+  /// 0 for blank cells
+  @ffi.Uint8()
+  external int digit;
+
+  /// classifier output for the digits 1 to 9, all 0 for blank cells
+  @ffi.Array.multi([9])
+  external ffi.Array<ffi.Float> probabilities;
+
+  /// bounding box of the digit in the warped grid image (WARPED_GRID_SIZE
+  /// pixels wide), all 0 for blank cells
+  @ffi.Int32()
+  external int x;
+
+  @ffi.Int32()
+  external int y;
+
+  @ffi.Int32()
+  external int width;
+
+  @ffi.Int32()
+  external int height;
+
+  /// 1 without any ink around the cell center, falling to 0 as ink grows
+  /// to the size of a digit
+  @ffi.Float()
+  external double blank_confidence;
+}
+
+/// row-major
+final class GridResult extends ffi.Struct {
+  @ffi.Array.multi([81])
+  external ffi.Array<CellResult> cells;
+}
+
+/// Raw YUV_420_888 / NV21 camera frame. Only the Y plane is read, it is used
+/// as grayscale input. The chroma planes are optional and may be null.
+final class YuvFrame extends ffi.Struct {
+  external ffi.Pointer<ffi.Uint8> y_plane;
+
+  external ffi.Pointer<ffi.Uint8> u_plane;
+
+  external ffi.Pointer<ffi.Uint8> v_plane;
+
+  @ffi.Int32()
+  external int width;
+
+  @ffi.Int32()
+  external int height;
+
+  @ffi.Int32()
+  external int y_row_stride;
+
+  @ffi.Int32()
+  external int uv_row_stride;
+
+  @ffi.Int32()
+  external int uv_pixel_stride;
+
+  /// clockwise rotation (0, 90, 180, 270) to get the upright image
+  @ffi.Int32()
+  external int rotation;
+}
+
+final class ScannerContext extends ffi.Opaque {}
+
+final class ScanSession extends ffi.Opaque {}
+
+final class TrackingSession extends ffi.Opaque {}
+
+const int TRACK_NONE = 0;
+
+const int TRACK_TRACKED = 1;
+
+const int TRACK_DETECTED = 2;
+
+const int BACKEND_AUTO = -1;
+
+const int BACKEND_CPU = 0;
+
+const int BACKEND_XNNPACK = 1;
+
+const int BACKEND_NNAPI = 2;
+
+const int BACKEND_COUNT = 3;
+
+const int THRESHOLD_SETTING_COUNT = 5;
+
+const int WARPED_GRID_SIZE = 450;
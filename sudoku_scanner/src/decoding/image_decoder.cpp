@@ -0,0 +1,148 @@
+#include "image_decoder.hpp"
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <opencv2/imgcodecs.hpp>
+
+#include "../profiling/scan_profiler.hpp"
+
+namespace {
+
+// Walks the JPEG marker segments up to the first SOFn and reads the frame
+// size from it. [read] copies n bytes at offset into dst.
+template <typename Read>
+bool parse_jpeg_size(Read read, cv::Size &size) {
+    std::uint8_t buffer[5];
+
+    // SOI
+    if (!read(0, buffer, 2) || buffer[0] != 0xFF || buffer[1] != 0xD8) {
+        return false;
+    }
+
+    std::size_t offset = 2;
+
+    while (read(offset, buffer, 4)) {
+        if (buffer[0] != 0xFF) {
+            return false;
+        }
+
+        const std::uint8_t marker = buffer[1];
+
+        // fill byte
+        if (marker == 0xFF) {
+            offset += 1;
+            continue;
+        }
+
+        // SOS or EOI, no frame header before the image data
+        if (marker == 0xDA || marker == 0xD9) {
+            return false;
+        }
+
+        const std::size_t length = (buffer[2] << 8) | buffer[3];
+
+        // SOF0 to SOF15 without DHT, JPG and DAC
+        if (marker >= 0xC0 && marker <= 0xCF && marker != 0xC4 && marker != 0xC8 && marker != 0xCC) {
+            // precision, height, width
+            if (!read(offset + 4, buffer, 5)) {
+                return false;
+            }
+
+            size = cv::Size((buffer[3] << 8) | buffer[4], (buffer[1] << 8) | buffer[2]);
+            return size.area() > 0;
+        }
+
+        offset += 2 + length;
+    }
+
+    return false;
+}
+
+}  // namespace
+
+cv::Mat ImageDecoder::decode(const char *path) {
+    SCAN_TIMER(DECODE);
+    return cv::imread(path, cv::IMREAD_GRAYSCALE);
+}
+
+cv::Mat ImageDecoder::decode(const std::uint8_t *data, std::size_t size) {
+    SCAN_TIMER(DECODE);
+    if (!data || size == 0) {
+        return cv::Mat();
+    }
+
+    // wraps the encoded bytes without copying them
+    const cv::Mat buffer(1, size, CV_8UC1, const_cast<std::uint8_t *>(data));
+    return cv::imdecode(buffer, cv::IMREAD_GRAYSCALE);
+}
+
+cv::Mat ImageDecoder::decode_reduced(const char *path, int factor) {
+    SCAN_TIMER(DECODE);
+    return cv::imread(path, reduced_flag(factor));
+}
+
+cv::Mat ImageDecoder::decode_reduced(const std::uint8_t *data, std::size_t size, int factor) {
+    SCAN_TIMER(DECODE);
+    if (!data || size == 0) {
+        return cv::Mat();
+    }
+
+    const cv::Mat buffer(1, size, CV_8UC1, const_cast<std::uint8_t *>(data));
+    return cv::imdecode(buffer, reduced_flag(factor));
+}
+
+bool ImageDecoder::read_size(const char *path, cv::Size &size) {
+    std::ifstream file(path, std::ios::binary);
+
+    if (!file) {
+        return false;
+    }
+
+    auto read = [&file](std::size_t offset, std::uint8_t *dst, std::size_t n) {
+        file.seekg(offset);
+        file.read(reinterpret_cast<char *>(dst), n);
+        return static_cast<std::size_t>(file.gcount()) == n;
+    };
+
+    return parse_jpeg_size(read, size);
+}
+
+bool ImageDecoder::read_size(const std::uint8_t *data, std::size_t size, cv::Size &output) {
+    if (!data) {
+        return false;
+    }
+
+    auto read = [data, size](std::size_t offset, std::uint8_t *dst, std::size_t n) {
+        if (offset + n > size) {
+            return false;
+        }
+        std::memcpy(dst, data + offset, n);
+        return true;
+    };
+
+    return parse_jpeg_size(read, output);
+}
+
+int ImageDecoder::reduction_factor(double src_length, double target_length) {
+    int factor = 1;
+
+    while (factor < 8 && src_length / (factor * 2) >= target_length) {
+        factor *= 2;
+    }
+
+    return factor;
+}
+
+int ImageDecoder::reduced_flag(int factor) {
+    switch (factor) {
+        case 2:
+            return cv::IMREAD_REDUCED_GRAYSCALE_2;
+        case 4:
+            return cv::IMREAD_REDUCED_GRAYSCALE_4;
+        case 8:
+            return cv::IMREAD_REDUCED_GRAYSCALE_8;
+        default:
+            return cv::IMREAD_GRAYSCALE;
+    }
+}
@@ -0,0 +1,27 @@
+#ifndef IMAGE_DECODER_HPP
+#define IMAGE_DECODER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <opencv2/core.hpp>
+
+class ImageDecoder {
+   public:
+    // full resolution grayscale decode
+    static cv::Mat decode(const char *path);
+    static cv::Mat decode(const std::uint8_t *data, std::size_t size);
+    // grayscale decode, downscaled by 1, 2, 4 or 8 while decoding (JPEG only)
+    static cv::Mat decode_reduced(const char *path, int factor);
+    static cv::Mat decode_reduced(const std::uint8_t *data, std::size_t size, int factor);
+    // reads the image size from the header without decoding, only for JPEG
+    static bool read_size(const char *path, cv::Size &size);
+    static bool read_size(const std::uint8_t *data, std::size_t size, cv::Size &output);
+    // biggest factor that keeps the given source length at or above target length
+    static int reduction_factor(double src_length, double target_length);
+
+   private:
+    ImageDecoder() = delete;
+    static int reduced_flag(int factor);
+};
+
+#endif
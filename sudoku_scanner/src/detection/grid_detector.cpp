@@ -1,28 +1,53 @@
 #include "grid_detector.hpp"
 
 #include <algorithm>
+#include <array>
+#include <atomic>
 #include <cmath>
+#include <mutex>
+#include <numeric>
 #include <opencv2/imgproc.hpp>
 #include <string>
 #include <tuple>
 #include <vector>
 
+#include "../profiling/scan_profiler.hpp"
+#include "integral_threshold.hpp"
+
 #ifdef DEVMODE
 #include <opencv2/highgui.hpp>
 #endif
 
 // TODO: maybe make some settings headers?
-const int RESOLUTION = 480;
-
-const double MIN_AREA = RESOLUTION * RESOLUTION / 10;
+const double MIN_AREA = GridDetector::RESOLUTION * GridDetector::RESOLUTION / 10;
 
-const std::vector<std::tuple<int, double>> THRESHOLD_SETTINGS = {
-    // blockSize and C for [cv::adaptiveThreshold]
+const std::array<std::tuple<int, double>, CascadeStatistics::SETTING_COUNT> THRESHOLD_SETTINGS = {{
+    // blockSize and C for mean adaptive thresholding
     {69, 20.0},
     {45, 15.0},
     {23, 10.0},
     {13, 10.0},
-    {9, 5.0}};
+    {9, 5.0}}};
+
+const int MAX_BLOCK_SIZE = std::get<0>(*std::max_element(THRESHOLD_SETTINGS.begin(), THRESHOLD_SETTINGS.end()));
+
+// lighting buckets by mean brightness and contrast of the detection image
+const int BRIGHTNESS_BUCKETS = 3;
+const int CONTRAST_BUCKETS = 2;
+const double LOW_CONTRAST = 40.0;
+
+static_assert(BRIGHTNESS_BUCKETS * CONTRAST_BUCKETS == CascadeState::LIGHTING_BUCKETS, "lighting bucket count out of sync");
+
+CascadeStatistics CascadeState::get_statistics() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return statistics;
+}
+
+void CascadeState::reset_statistics() {
+    std::lock_guard<std::mutex> lock(mutex);
+    statistics = CascadeStatistics();
+    std::fill(&bucket_successes[0][0], &bucket_successes[0][0] + sizeof(bucket_successes) / sizeof(std::uint32_t), 0);
+}
 
 // TODO: move to helper headers (helper.hpp utility.hpp ?)
 void GridDetector::resize_to_resolution(cv::Mat &img, int resolution) {
@@ -60,50 +85,204 @@ void GridDetector::sort_quadrilateral(std::vector<cv::Point> &quadrilateral) {
     std::sort(quadrilateral.begin() + 1, quadrilateral.end() - 1, has_smaller_diff);
 }
 
-std::vector<cv::Point> GridDetector::detect_grid(cv::Mat &img) {
+cv::Mat GridDetector::preprocess(const cv::Mat &img) {
+    SCAN_TIMER(PREPROCESS);
+    cv::Mat preprocessed;
+    // grayscale input (e.g. Y plane of a camera frame) needs no conversion
+    if (img.channels() > 1) {
+        cv::cvtColor(img, preprocessed, cv::COLOR_BGR2GRAY);
+    } else {
+        preprocessed = img;
+    }
+    cv::pyrDown(preprocessed, preprocessed);
+    cv::pyrUp(preprocessed, preprocessed);
+    resize_to_resolution(preprocessed, RESOLUTION);
+
+    return preprocessed;
+}
+
+std::vector<cv::Point> GridDetector::detect_grid(cv::Mat &img, CascadeState &cascade) {
     cv::Size src_size = img.size();
-    cv::cvtColor(img, img, cv::COLOR_BGR2GRAY);
-    cv::pyrDown(img, img);
-    cv::pyrUp(img, img);
-    resize_to_resolution(img, RESOLUTION);
+    img = preprocess(img);
 
-    cv::Mat thresholded;
+    return detect_grid(img, src_size, cascade);
+}
+
+std::vector<cv::Point> GridDetector::detect_grid(const cv::Mat &preprocessed, cv::Size src_size, CascadeState &cascade) {
     std::vector<cv::Point> detection;
 
+    if (!locate_grid(preprocessed, detection, cascade)) {
+        // no detection
+        return {cv::Point(0, 0),
+                cv::Point(src_size.width - 1, 0),
+                cv::Point(0, src_size.height - 1),
+                cv::Point(src_size.width - 1, src_size.height - 1)};
+    }
+
     // change of basis from resized image to original source image
-    double t_x = static_cast<double>(src_size.width) / img.size().width;
-    double t_y = static_cast<double>(src_size.height) / img.size().height;
+    double t_x = static_cast<double>(src_size.width) / preprocessed.size().width;
+    double t_y = static_cast<double>(src_size.height) / preprocessed.size().height;
+
+    // get points in original sized image
+    for (cv::Point &point : detection) {
+        point.x *= t_x;
+        point.y *= t_y;
+    }
+
+    return detection;
+}
+
+bool GridDetector::locate_grid(const cv::Mat &preprocessed, std::vector<cv::Point> &output, CascadeState &cascade) {
+    SCAN_TIMER(LOCATE_GRID);
+    const int bucket = lighting_bucket(preprocessed);
+    const std::vector<int> order = cascade_order(cascade, bucket);
+    // shared by all threshold settings
+    const IntegralThreshold thresholder(preprocessed, MAX_BLOCK_SIZE);
+
+    int setting = -1;
+    int passes = 0;
+    bool has_sudoku_grid = cascade.parallel
+                               ? locate_grid_parallel(thresholder, order, output, setting, passes)
+                               : locate_grid_sequential(thresholder, order, output, setting, passes);
+
+    record_detection(cascade, bucket, setting, passes);
+    SCAN_COUNT(THRESHOLD_PASSES, passes);
+
+    if (!has_sudoku_grid) {
+        return false;
+    }
+
+    sort_quadrilateral(output);
 
-    for (const auto &[block_size, c] : THRESHOLD_SETTINGS) {
-        cv::adaptiveThreshold(img, thresholded, 255, cv::ADAPTIVE_THRESH_MEAN_C, cv::THRESH_BINARY_INV, block_size, c);
-        bool has_sudoku_grid = find_sudoku_grid(thresholded, detection);
+#ifdef DEVMODE
+    cv::Mat preview;
+    cv::cvtColor(preprocessed, preview, cv::COLOR_GRAY2BGR);
+    cv::polylines(preview, std::vector{output[0], output[1], output[3], output[2]}, true, cv::Scalar(0, 0, 255));
+    cv::imshow("detection", preview);
+#endif
+
+    return true;
+}
+
+bool GridDetector::locate_grid_sequential(const IntegralThreshold &thresholder, const std::vector<int> &order, std::vector<cv::Point> &output, int &setting, int &passes) {
+    cv::Mat thresholded;
+
+    for (int index : order) {
+        const auto &[block_size, c] = THRESHOLD_SETTINGS[index];
+        thresholder.apply(thresholded, block_size, c);
+        bool has_sudoku_grid = find_sudoku_grid(thresholded, output);
+        passes++;
 
 #ifdef DEVMODE
         std::string name = "Threshold " + std::to_string(block_size) + ", " + std::to_string(c) + " (detection)";
         cv::imshow(name, thresholded);
 #endif
         if (has_sudoku_grid) {
-            sort_quadrilateral(detection);
+            setting = index;
+            return true;
+        }
+    }
 
-#ifdef DEVMODE
-            cv::cvtColor(img, img, cv::COLOR_GRAY2BGR);
-            cv::polylines(img, std::vector{detection[0], detection[1], detection[3], detection[2]}, true, cv::Scalar(0, 0, 255));
-            cv::imshow("detection", img);
-#endif
-            // get points in original sized image
-            for (cv::Point &point : detection) {
-                point.x *= t_x;
-                point.y *= t_y;
+    return false;
+}
+
+bool GridDetector::locate_grid_parallel(const IntegralThreshold &thresholder, const std::vector<int> &order, std::vector<cv::Point> &output, int &setting, int &passes) {
+    const int count = order.size();
+    std::vector<cv::Mat> thresholded(count);
+    std::vector<std::vector<cv::Point>> detections(count);
+    // no std::vector<bool>, its elements can't be written concurrently
+    std::vector<char> found(count, false);
+    // position in order of best successful setting so far, later ones need not run
+    std::atomic<int> best_position{count};
+
+    cv::parallel_for_(cv::Range(0, count), [&](const cv::Range &range) {
+        for (int i = range.start; i < range.end; ++i) {
+            if (best_position < i) {
+                continue;
             }
 
-            return detection;
+            const auto &[block_size, c] = THRESHOLD_SETTINGS[order[i]];
+            thresholder.apply(thresholded[i], block_size, c);
+            found[i] = find_sudoku_grid(thresholded[i], detections[i]);
+
+            if (found[i]) {
+                int best = best_position;
+                while (i < best && !best_position.compare_exchange_weak(best, i)) {
+                }
+            }
+        }
+    });
+
+    for (int i = 0; i < count; ++i) {
+        if (thresholded[i].empty()) {
+            continue;
         }
+        passes++;
+
+#ifdef DEVMODE
+        // highgui must only be used from this thread
+        const auto &[block_size, c] = THRESHOLD_SETTINGS[order[i]];
+        std::string name = "Threshold " + std::to_string(block_size) + ", " + std::to_string(c) + " (detection)";
+        cv::imshow(name, thresholded[i]);
+#endif
+    }
+
+    // result only depends on the order of settings, not on scheduling
+    if (best_position == count) {
+        return false;
+    }
+
+    setting = order[best_position];
+    output = detections[best_position];
+
+    return true;
+}
+
+const std::array<std::tuple<int, double>, CascadeStatistics::SETTING_COUNT> &GridDetector::threshold_settings() {
+    return THRESHOLD_SETTINGS;
+}
+
+int GridDetector::lighting_bucket(const cv::Mat &preprocessed) {
+    cv::Scalar mean, stddev;
+    cv::meanStdDev(preprocessed, mean, stddev);
+
+    int brightness = std::min(static_cast<int>(mean[0] * BRIGHTNESS_BUCKETS / 256.0), BRIGHTNESS_BUCKETS - 1);
+    int contrast = stddev[0] < LOW_CONTRAST ? 0 : 1;
+
+    return brightness * CONTRAST_BUCKETS + contrast;
+}
+
+std::vector<int> GridDetector::cascade_order(const CascadeState &cascade, int bucket) {
+    std::vector<int> order(THRESHOLD_SETTINGS.size());
+    std::iota(order.begin(), order.end(), 0);
+
+    if (!cascade.adaptive) {
+        return order;
+    }
+
+    std::uint32_t successes[CascadeStatistics::SETTING_COUNT];
+    {
+        std::lock_guard<std::mutex> lock(cascade.mutex);
+        std::copy(std::begin(cascade.bucket_successes[bucket]), std::end(cascade.bucket_successes[bucket]), successes);
+    }
+
+    // most successful first, ties keep original priority
+    std::stable_sort(order.begin(), order.end(), [&successes](int a, int b) { return successes[a] > successes[b]; });
+
+    return order;
+}
+
+void GridDetector::record_detection(CascadeState &cascade, int bucket, int setting, int passes) {
+    std::lock_guard<std::mutex> lock(cascade.mutex);
+
+    cascade.statistics.detections++;
+    cascade.statistics.threshold_passes += passes;
+
+    if (setting >= 0) {
+        cascade.statistics.successes++;
+        cascade.statistics.setting_successes[setting]++;
+        cascade.bucket_successes[bucket][setting]++;
     }
-    // no detection
-    return {cv::Point(0, 0),
-            cv::Point(src_size.width - 1, 0),
-            cv::Point(0, src_size.height - 1),
-            cv::Point(src_size.width - 1, src_size.height - 1)};
 }
 
 bool GridDetector::find_sudoku_grid(const cv::Mat &binary, std::vector<cv::Point> &output) {
@@ -138,9 +317,10 @@ bool GridDetector::find_sudoku_grid(const cv::Mat &binary, std::vector<cv::Point
             double d3 = cv::norm(poly_approx[0] - poly_approx[1]);
             double d4 = cv::norm(poly_approx[1] - poly_approx[2]);
 
-            printf("%f %f %f %f\n", d1, d2, d3, d4);
+            SCAN_COUNT(QUADRILATERALS, 1);
 
             if (!(d3 * 4 > d4 && d4 * 4 > d3 && d3 * d4 < area * 1.5 && d1 >= 0.15 * p && d2 >= 0.15 * p)) {
+                SCAN_COUNT(REJECTED_QUADRILATERALS, 1);
                 continue;
             }
 
@@ -1,18 +1,78 @@
 #ifndef GRID_DETECTOR_HPP
 #define GRID_DETECTOR_HPP
 
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
 #include <opencv2/core.hpp>
+#include <tuple>
 #include <vector>
 
+class IntegralThreshold;
+
+// collected over all detections since the last reset
+struct CascadeStatistics {
+    static constexpr int SETTING_COUNT = 5;
+
+    std::uint32_t detections = 0;
+    std::uint32_t successes = 0;
+    std::uint32_t threshold_passes = 0;
+    // successes per threshold setting, in original priority order
+    std::uint32_t setting_successes[SETTING_COUNT] = {};
+};
+
+// Tuning and learned statistics of the threshold cascade. Each scanner
+// context has its own, all members are safe to use from several threads.
+class CascadeState {
+   public:
+    // lighting buckets (brightness times contrast) the successes are kept for
+    static constexpr int LIGHTING_BUCKETS = 6;
+
+    // evaluate all threshold settings at once across cores
+    std::atomic<bool> parallel{false};
+    // try the settings that succeeded most often for similar lighting first
+    std::atomic<bool> adaptive{false};
+
+    CascadeStatistics get_statistics() const;
+    void reset_statistics();
+
+   private:
+    friend class GridDetector;
+
+    mutable std::mutex mutex;
+    CascadeStatistics statistics;
+    // successes per lighting bucket and setting, used for ordering
+    std::uint32_t bucket_successes[LIGHTING_BUCKETS][CascadeStatistics::SETTING_COUNT] = {};
+};
+
 class GridDetector {
    public:
-    static std::vector<cv::Point> detect_grid(cv::Mat &img);
+    // working resolution (shorter side) of the detection
+    static constexpr int RESOLUTION = 480;
+
+    static std::vector<cv::Point> detect_grid(cv::Mat &img, CascadeState &cascade);
+    // detection on an image already run through [preprocess], e.g. a cached one
+    static std::vector<cv::Point> detect_grid(const cv::Mat &preprocessed, cv::Size src_size, CascadeState &cascade);
+    // grayscale, denoised and downscaled image used for detection
+    static cv::Mat preprocess(const cv::Mat &img);
+    // sorted corners in preprocessed image coordinates, false if no grid found
+    static bool locate_grid(const cv::Mat &preprocessed, std::vector<cv::Point> &output, CascadeState &cascade);
+
+    // block size and C of every cascade setting, in priority order
+    static const std::array<std::tuple<int, double>, CascadeStatistics::SETTING_COUNT> &threshold_settings();
+    // one cascade pass on a thresholded image, public to benchmark it separately
+    static bool find_sudoku_grid(const cv::Mat &vector, std::vector<cv::Point> &output);
 
    private:
     GridDetector() = delete;
     static void resize_to_resolution(cv::Mat &img, int resolution);
+    static bool locate_grid_sequential(const IntegralThreshold &thresholder, const std::vector<int> &order, std::vector<cv::Point> &output, int &setting, int &passes);
+    static bool locate_grid_parallel(const IntegralThreshold &thresholder, const std::vector<int> &order, std::vector<cv::Point> &output, int &setting, int &passes);
+    static int lighting_bucket(const cv::Mat &preprocessed);
+    static std::vector<int> cascade_order(const CascadeState &cascade, int bucket);
+    static void record_detection(CascadeState &cascade, int bucket, int setting, int passes);
     static void sort_quadrilateral(std::vector<cv::Point> &quadrilateral);
-    static bool find_sudoku_grid(const cv::Mat &vector, std::vector<cv::Point> &output);
     static cv::Mat get_hough_lines(cv::Mat &img);
 };
 
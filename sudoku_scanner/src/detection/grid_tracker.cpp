@@ -0,0 +1,128 @@
+#include "grid_tracker.hpp"
+
+#include <algorithm>
+#include <opencv2/imgproc.hpp>
+#include <vector>
+
+#include "grid_detector.hpp"
+
+// all sizes in detection resolution
+const int PATCH_RADIUS = 12;
+const int SEARCH_RADIUS = 24;
+const double MIN_SCORE = 0.6;
+const double MIN_AREA = GridDetector::RESOLUTION * GridDetector::RESOLUTION / 10;
+
+GridTracker::Result GridTracker::track(const cv::Mat &frame, CascadeState &cascade, std::vector<cv::Point> &output) {
+    cv::Mat preprocessed = GridDetector::preprocess(frame);
+    std::vector<cv::Point> detection;
+    Result result = Result::NONE;
+
+    if (is_tracking() && tracked_frames < MAX_TRACKED_FRAMES && track_corners(preprocessed, detection)) {
+        result = Result::TRACKED;
+        ++tracked_frames;
+    } else if (GridDetector::locate_grid(preprocessed, detection, cascade)) {
+        result = Result::DETECTED;
+        confidence = 1.0;
+        tracked_frames = 0;
+        // keep state in detection resolution
+        keyframe = preprocessed;
+        keyframe_corners = detection;
+    }
+
+    if (result == Result::NONE) {
+        reset();
+        return result;
+    }
+
+    corners = detection;
+
+    // change of basis from resized image to frame
+    double t_x = static_cast<double>(frame.size().width) / preprocessed.size().width;
+    double t_y = static_cast<double>(frame.size().height) / preprocessed.size().height;
+
+    output = detection;
+    for (cv::Point &point : output) {
+        point.x *= t_x;
+        point.y *= t_y;
+    }
+
+    return result;
+}
+
+void GridTracker::reset() {
+    keyframe.release();
+    keyframe_corners.clear();
+    corners.clear();
+    tracked_frames = 0;
+    confidence = 0.0;
+}
+
+bool GridTracker::is_tracking() const {
+    return !corners.empty();
+}
+
+double GridTracker::get_confidence() const {
+    return confidence;
+}
+
+bool GridTracker::track_corners(const cv::Mat &preprocessed, std::vector<cv::Point> &output) {
+    // camera might have been rotated or resized
+    if (preprocessed.size() != keyframe.size()) {
+        return false;
+    }
+
+    double min_score = 1.0;
+    output.resize(corners.size());
+
+    for (std::size_t i = 0; i < corners.size(); ++i) {
+        double score;
+
+        if (!match_corner(preprocessed, i, output[i], score) || score < MIN_SCORE) {
+            return false;
+        }
+
+        min_score = std::min(min_score, score);
+    }
+
+    if (!is_plausible(output)) {
+        return false;
+    }
+
+    confidence = min_score;
+    return true;
+}
+
+// template from the keyframe, searched around the previous position
+bool GridTracker::match_corner(const cv::Mat &preprocessed, std::size_t index, cv::Point &output, double &score) {
+    const cv::Point &template_corner = keyframe_corners[index];
+    const cv::Point &corner = corners[index];
+    const cv::Rect bounds(cv::Point(0, 0), keyframe.size());
+    const cv::Rect patch_rect(template_corner.x - PATCH_RADIUS, template_corner.y - PATCH_RADIUS, 2 * PATCH_RADIUS + 1,
+                              2 * PATCH_RADIUS + 1);
+
+    // corner too close to the border for a full patch
+    if ((patch_rect & bounds) != patch_rect) {
+        return false;
+    }
+
+    const int radius = PATCH_RADIUS + SEARCH_RADIUS;
+    const cv::Rect search_rect = cv::Rect(corner.x - radius, corner.y - radius, 2 * radius + 1, 2 * radius + 1) & bounds;
+
+    cv::Mat scores;
+    cv::matchTemplate(preprocessed(search_rect), keyframe(patch_rect), scores, cv::TM_CCOEFF_NORMED);
+
+    cv::Point best;
+    cv::minMaxLoc(scores, nullptr, &score, nullptr, &best);
+
+    // match location is the top left corner of the patch
+    output = search_rect.tl() + best + cv::Point(PATCH_RADIUS, PATCH_RADIUS);
+
+    return true;
+}
+
+bool GridTracker::is_plausible(const std::vector<cv::Point> &quadrilateral) {
+    // ordered as polygon: top left, top right, bottom right, bottom left
+    std::vector<cv::Point> polygon{quadrilateral[0], quadrilateral[1], quadrilateral[3], quadrilateral[2]};
+
+    return cv::isContourConvex(polygon) && cv::contourArea(polygon) > MIN_AREA;
+}
@@ -0,0 +1,47 @@
+#ifndef GRID_TRACKER_HPP
+#define GRID_TRACKER_HPP
+
+#include <opencv2/core.hpp>
+#include <vector>
+
+class CascadeState;
+
+// Follows a detected grid through consecutive video frames. The corners as
+// they looked in the last detected frame are searched for locally around
+// their previous position, so match errors do not add up from frame to
+// frame. A full detection runs when tracking gets unreliable and at least
+// every MAX_TRACKED_FRAMES frames.
+class GridTracker {
+   public:
+    static constexpr int MAX_TRACKED_FRAMES = 30;
+
+    enum class Result {
+        NONE,
+        TRACKED,
+        DETECTED,
+    };
+
+    // output is ordered like [GridDetector::detect_grid] in frame coordinates,
+    // full detections run with the given cascade
+    Result track(const cv::Mat &frame, CascadeState &cascade, std::vector<cv::Point> &output);
+    void reset();
+    bool is_tracking() const;
+    // lowest corner match score of the last tracked frame, in [-1, 1]
+    double get_confidence() const;
+
+   private:
+    bool track_corners(const cv::Mat &preprocessed, std::vector<cv::Point> &output);
+    bool match_corner(const cv::Mat &preprocessed, std::size_t index, cv::Point &output, double &score);
+    static bool is_plausible(const std::vector<cv::Point> &quadrilateral);
+
+    // last detected frame and its corners, the templates for tracking
+    cv::Mat keyframe;
+    std::vector<cv::Point> keyframe_corners;
+    // corners of the previous frame, where the search starts
+    std::vector<cv::Point> corners;
+    // frames tracked since the last detection
+    int tracked_frames = 0;
+    double confidence = 0.0;
+};
+
+#endif
@@ -0,0 +1,42 @@
+#include "integral_threshold.hpp"
+
+#include <cassert>
+#include <opencv2/imgproc.hpp>
+
+IntegralThreshold::IntegralThreshold(const cv::Mat &gray, int max_block_size) : image(gray), padding(max_block_size / 2) {
+    assert(gray.type() == CV_8UC1);
+
+    // replicated border like cv::adaptiveThreshold, so no clipping needed later
+    cv::Mat padded;
+    cv::copyMakeBorder(gray, padded, padding, padding, padding, padding, cv::BORDER_REPLICATE);
+    cv::integral(padded, sums, CV_32S);
+}
+
+void IntegralThreshold::apply(cv::Mat &output, int block_size, double c) const {
+    assert(block_size % 2 == 1 && block_size / 2 <= padding);
+
+    output.create(image.size(), CV_8UC1);
+
+    const int radius = block_size / 2;
+    const int area = block_size * block_size;
+    // cv::adaptiveThreshold floors C for THRESH_BINARY_INV
+    const int delta = cvFloor(c) * area;
+    // column offsets of the window into a row of sums
+    const int left = padding - radius;
+    const int right = padding + radius + 1;
+
+    cv::parallel_for_(cv::Range(0, image.rows), [&](const cv::Range &range) {
+        for (int y = range.start; y < range.end; ++y) {
+            const uchar *src = image.ptr<uchar>(y);
+            uchar *dst = output.ptr<uchar>(y);
+            const int *top = sums.ptr<int>(y + padding - radius);
+            const int *bottom = sums.ptr<int>(y + padding + radius + 1);
+
+            // src <= mean - C, kept in integers and branch free to allow vectorization
+            for (int x = 0; x < image.cols; ++x) {
+                const int sum = bottom[x + right] - bottom[x + left] - top[x + right] + top[x + left];
+                dst[x] = (src[x] * area + delta <= sum) ? 255 : 0;
+            }
+        }
+    });
+}
@@ -0,0 +1,24 @@
+#ifndef INTEGRAL_THRESHOLD_HPP
+#define INTEGRAL_THRESHOLD_HPP
+
+#include <opencv2/core.hpp>
+
+// Adaptive mean thresholding for many block sizes on the same image. The
+// integral image is built once, after that every threshold costs O(1) per
+// pixel regardless of block size.
+class IntegralThreshold {
+   public:
+    IntegralThreshold(const cv::Mat &gray, int max_block_size);
+
+    // same as cv::adaptiveThreshold with ADAPTIVE_THRESH_MEAN_C and
+    // THRESH_BINARY_INV, except the local mean is not rounded
+    void apply(cv::Mat &output, int block_size, double c) const;
+
+   private:
+    const cv::Mat image;
+    // integral image of the border replicated input
+    cv::Mat sums;
+    const int padding;
+};
+
+#endif
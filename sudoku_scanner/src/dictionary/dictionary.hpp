@@ -1,6 +0,0 @@
-#ifndef DICTIONARY_HPP
-#define DICTIONARY_HPP
-
-const char *const PATH_TO_MODEL_ENV_VAR = "PATH_TO_MODEL";
-
-#endif
@@ -2,85 +2,606 @@
 
 #include <tensorflow/lite/c/c_api.h>
 #include <tensorflow/lite/delegates/nnapi/nnapi_delegate_c_api.h>
+#include <tensorflow/lite/delegates/xnnpack/xnnpack_delegate.h>
 
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <fstream>
+#include <mutex>
 #include <opencv2/imgproc.hpp>
 #include <string>
+#include <thread>
 #include <vector>
 
-#include "../../dictionary/dictionary.hpp"
+#include "../../profiling/scan_profiler.hpp"
+#include "../../utils/bits.hpp"
 #include "../structs/cell.hpp"
 
 #ifdef __ANDROID__
 #include <android/log.h>
 #endif
 
-void NumberClassifier::predict_numbers(std::vector<Cell> &cells) {
-    cv::Mat input;
-    std::vector<float> output(9, 0.0);
-    std::string path_to_model = std::getenv(PATH_TO_MODEL_ENV_VAR);
+namespace {
+
+const int INPUT_SIZE = 28;
+const int NUM_CLASSES = 9;
+// largest batch a scan can classify
+const int MAX_CELLS = 81;
+// more interpreters than this only cost memory, a scan never runs more than
+// a handful of extractions at once
+const int DEFAULT_POOL_SIZE = 4;
+// threads of the cpu backends, shared among the interpreters of the pool
+const int CPU_THREADS = 4;
+// timed inferences per backend, after one untimed for delegate preparation
+const int BENCHMARK_RUNS = 5;
+
+// result of AUTO for one model, shared by all classifiers of the process
+struct CachedSelection {
+    std::uint64_t model_size;
+    std::uint64_t model_hash;
+    BackendSelection selection;
+};
+
+std::mutex selection_mutex;
+std::vector<CachedSelection> selections;
+
+const std::uint64_t FNV_OFFSET = 14695981039346656037ull;
+
+// FNV-1a, continued from hash
+std::uint64_t hash_bytes(const std::uint8_t *data, std::size_t size, std::uint64_t hash = FNV_OFFSET) {
+    for (std::size_t i = 0; i < size; ++i) {
+        hash = (hash ^ data[i]) * 1099511628211ull;
+    }
+    return hash;
+}
+
+}  // namespace
+
+// One interpreter of the pool with its own delegate and input shape.
+struct NumberClassifier::Interpreter {
+    InferenceBackend backend = InferenceBackend::CPU;
+    TfLiteDelegate *delegate = nullptr;
+    TfLiteInterpreterOptions *options = nullptr;
+    TfLiteInterpreter *interpreter = nullptr;
+    // current first dimension of the input tensor
+    int batch_size = 1;
+
+    // returns null if the backend is not available
+    static std::unique_ptr<Interpreter> create(TfLiteModel *model, InferenceBackend backend, int cpu_threads);
+
+    ~Interpreter() {
+        // interpreter has to go before its options and delegate
+        if (interpreter) TfLiteInterpreterDelete(interpreter);
+        if (options) TfLiteInterpreterOptionsDelete(options);
+        if (!delegate) return;
 
-    TfLiteNnapiDelegateOptions nnapi_options = TfLiteNnapiDelegateOptionsDefault();
-    nnapi_options.execution_preference = TfLiteNnapiDelegateOptions::ExecutionPreference::kSustainedSpeed;
-    TfLiteDelegate *delegate = TfLiteNnapiDelegateCreate(&nnapi_options);
-    TfLiteInterpreterOptions *options = TfLiteInterpreterOptionsCreate();
-    TfLiteInterpreterOptionsAddDelegate(options, delegate);
+        if (backend == InferenceBackend::NNAPI) {
+            TfLiteNnapiDelegateDelete(delegate);
+        } else {
+            TfLiteXNNPackDelegateDelete(delegate);
+        }
+    }
+};
+
+std::unique_ptr<NumberClassifier::Interpreter> NumberClassifier::Interpreter::create(TfLiteModel *model, InferenceBackend backend, int cpu_threads) {
+    std::unique_ptr<Interpreter> result(new Interpreter());
+    result->backend = backend;
+    result->options = TfLiteInterpreterOptionsCreate();
+
+    switch (backend) {
+        case InferenceBackend::NNAPI: {
+            TfLiteNnapiDelegateOptions nnapi_options = TfLiteNnapiDelegateOptionsDefault();
+            nnapi_options.execution_preference = TfLiteNnapiDelegateOptions::ExecutionPreference::kSustainedSpeed;
+            result->delegate = TfLiteNnapiDelegateCreate(&nnapi_options);
+            break;
+        }
+        case InferenceBackend::XNNPACK: {
+            TfLiteXNNPackDelegateOptions xnnpack_options = TfLiteXNNPackDelegateOptionsDefault();
+            xnnpack_options.num_threads = cpu_threads;
+            result->delegate = TfLiteXNNPackDelegateCreate(&xnnpack_options);
+            break;
+        }
+        default:
+            TfLiteInterpreterOptionsSetNumThreads(result->options, cpu_threads);
+            break;
+    }
 
-    // create the model
-    TfLiteModel *model = TfLiteModelCreateFromFile(path_to_model.data());
+    if (backend != InferenceBackend::CPU) {
+        if (!result->delegate) {
+            return nullptr;
+        }
+        TfLiteInterpreterOptionsAddDelegate(result->options, result->delegate);
+    }
 
     // create the interpreter
-    TfLiteInterpreter *interpreter = TfLiteInterpreterCreate(model, options);
+    result->interpreter = TfLiteInterpreterCreate(model, result->options);
+
+    // allocate tensors
+    if (!result->interpreter || TfLiteInterpreterAllocateTensors(result->interpreter) != kTfLiteOk) {
+        return nullptr;
+    }
+
+    return result;
+}
+
+// Everything needed for inference. Built once by [NumberClassifier::load_model]
+// and reused by every scan, so steady-state scans only pay for inference.
+struct NumberClassifier::Engine {
+    TfLiteModel *model = nullptr;
+    // size and hash of the flatbuffer, key of the process wide AUTO cache
+    std::uint64_t model_size = 0;
+    std::uint64_t model_hash = 0;
+    BackendSelection selection;
+    // backing memory of a model created from a buffer, empty for files
+    std::vector<std::uint8_t> model_data;
+    std::vector<std::unique_ptr<Interpreter>> interpreters;
+
+    ~Engine() {
+        reset();
+    }
+
+    void reset() {
+        // interpreters have to go before the model
+        interpreters.clear();
+        if (model) TfLiteModelDelete(model);
+        model = nullptr;
+        model_size = 0;
+        model_hash = 0;
+        selection = BackendSelection();
+        // only after the model, which reads from it
+        model_data.clear();
+        model_data.shrink_to_fit();
+    }
+};
+
+// Holds one interpreter of the pool for the lifetime of a prediction.
+class NumberClassifier::Lease {
+   public:
+    explicit Lease(NumberClassifier &classifier) : classifier(classifier), slot(classifier.checkout()) {}
+
+    ~Lease() {
+        classifier.give_back(slot);
+    }
+
+    Lease(const Lease &) = delete;
+    Lease &operator=(const Lease &) = delete;
+
+    Interpreter &get() const {
+        return *classifier.engine->interpreters[slot];
+    }
+
+   private:
+    NumberClassifier &classifier;
+    const int slot;
+};
+
+NumberClassifier::NumberClassifier() : engine(new Engine()) {}
+
+NumberClassifier::~NumberClassifier() = default;
+
+bool NumberClassifier::load_model(const char *path, InferenceBackend backend, int pool_size) {
+    release_model();
+
+    // create the model, shared by all interpreters
+    engine->model = TfLiteModelCreateFromFile(path);
+
+    // the file is mapped by TFLite, read it once more for the cache key
+    std::ifstream file(path, std::ios::binary);
+    std::uint8_t chunk[4096];
+    engine->model_hash = FNV_OFFSET;
+    while (file) {
+        file.read(reinterpret_cast<char *>(chunk), sizeof(chunk));
+        engine->model_hash = hash_bytes(chunk, file.gcount(), engine->model_hash);
+        engine->model_size += file.gcount();
+    }
+
+    return create_pool(backend, pool_size);
+}
+
+bool NumberClassifier::load_model(const std::uint8_t *data, std::size_t size, InferenceBackend backend, int pool_size) {
+    release_model();
+
+    // TFLite does not copy the buffer, so it has to outlive the model
+    engine->model_data.assign(data, data + size);
+    engine->model = TfLiteModelCreate(engine->model_data.data(), engine->model_data.size());
+    engine->model_size = size;
+    engine->model_hash = hash_bytes(data, size);
+
+    return create_pool(backend, pool_size);
+}
+
+// builds the interpreters on the freshly created model
+bool NumberClassifier::create_pool(InferenceBackend backend, int pool_size) {
+    if (!engine->model) {
+        engine->reset();
+        return false;
+    }
+
+    if (pool_size <= 0) {
+        const int cores = std::thread::hardware_concurrency();
+        pool_size = std::max(1, std::min(cores, DEFAULT_POOL_SIZE));
+    }
+    pool_size = std::min(pool_size, MAX_POOL_SIZE);
+
+    const int cpu_threads = std::max(1, CPU_THREADS / pool_size);
+    engine->selection = select_backend(*engine, backend, cpu_threads);
+
+    for (int i = 0; i < pool_size; ++i) {
+        std::unique_ptr<Interpreter> interpreter = Interpreter::create(engine->model, engine->selection.backend, cpu_threads);
+
+        // requested backend not available on this device
+        if (!interpreter && i == 0 && engine->selection.backend != InferenceBackend::CPU) {
+            engine->selection.backend = InferenceBackend::CPU;
+            interpreter = Interpreter::create(engine->model, InferenceBackend::CPU, cpu_threads);
+        }
+
+        // a smaller pool still works
+        if (!interpreter) {
+            break;
+        }
+
+        engine->interpreters.push_back(std::move(interpreter));
+    }
+
+    if (engine->interpreters.empty()) {
+        engine->reset();
+        return false;
+    }
+
+    const int size = engine->interpreters.size();
+    free_slots.store(size == MAX_POOL_SIZE ? ~std::uint64_t(0) : (std::uint64_t(1) << size) - 1, std::memory_order_release);
+
+    return true;
+}
+
+void NumberClassifier::release_model() {
+    free_slots.store(0, std::memory_order_relaxed);
+    checkouts.store(0, std::memory_order_relaxed);
+    contended_checkouts.store(0, std::memory_order_relaxed);
+    in_use.store(0, std::memory_order_relaxed);
+    peak_in_use.store(0, std::memory_order_relaxed);
+    engine->reset();
+}
+
+bool NumberClassifier::is_loaded() const {
+    return !engine->interpreters.empty();
+}
+
+// Explicit backends are taken as they are. AUTO measures every backend once
+// per process, as the fastest one only depends on the device and the model.
+BackendSelection NumberClassifier::select_backend(const Engine &engine, InferenceBackend backend, int threads) {
+    BackendSelection result;
+    result.threads = threads;
+
+    if (backend != InferenceBackend::AUTO) {
+        result.backend = backend;
+        return result;
+    }
+
+    std::lock_guard<std::mutex> lock(selection_mutex);
+
+    for (const CachedSelection &cached : selections) {
+        if (cached.model_size == engine.model_size && cached.model_hash == engine.model_hash &&
+            cached.selection.threads == threads) {
+            result = cached.selection;
+            result.cached = true;
+            return result;
+        }
+    }
+
+    std::uint32_t fastest = 0;
+
+    for (int i = 0; i < BackendSelection::CANDIDATE_COUNT; ++i) {
+        const InferenceBackend candidate = static_cast<InferenceBackend>(i);
+        const std::uint32_t microseconds = benchmark_backend(engine.model, candidate, threads);
+        result.benchmark_us[i] = microseconds;
+
+        if (microseconds > 0 && (fastest == 0 || microseconds < fastest)) {
+            fastest = microseconds;
+            result.backend = candidate;
+        }
+    }
+
+    selections.push_back({engine.model_size, engine.model_hash, result});
+
+    return result;
+}
+
+// Median time to classify a full grid the way predict_numbers would, 0 if
+// the backend is not available.
+std::uint32_t NumberClassifier::benchmark_backend(TfLiteModel *model, InferenceBackend backend, int threads) {
+    std::unique_ptr<Interpreter> interpreter = Interpreter::create(model, backend, threads);
 
-    // fallback to no delegate
     if (!interpreter) {
-        TfLiteInterpreterOptionsDelete(options);
-        options = TfLiteInterpreterOptionsCreate();
-        TfLiteInterpreterOptionsSetNumThreads(options, 4);
-        interpreter = TfLiteInterpreterCreate(model, options);
+        return 0;
     }
 
-    // allocate tensors
-    TfLiteInterpreterAllocateTensors(interpreter);
-    TfLiteTensor *input_tensor = TfLiteInterpreterGetInputTensor(interpreter, 0);
-    const TfLiteTensor *output_tensor = TfLiteInterpreterGetOutputTensor(interpreter, 0);
+    // without batch support every cell takes its own invoke
+    const bool batched = resize_batch(*interpreter, MAX_CELLS);
+    const int invokes = batched ? 1 : MAX_CELLS;
+    const std::vector<float> input(MAX_CELLS * INPUT_SIZE * INPUT_SIZE, 0.0f);
+    const std::size_t input_bytes = (batched ? MAX_CELLS : 1) * INPUT_SIZE * INPUT_SIZE * sizeof(float);
+    TfLiteTensor *input_tensor = TfLiteInterpreterGetInputTensor(interpreter->interpreter, 0);
+
+    std::vector<std::uint32_t> times;
+
+    for (int run = 0; run <= BENCHMARK_RUNS; ++run) {
+        const auto start = std::chrono::steady_clock::now();
+
+        for (int i = 0; i < invokes; ++i) {
+            TfLiteTensorCopyFromBuffer(input_tensor, input.data(), input_bytes);
+            if (TfLiteInterpreterInvoke(interpreter->interpreter) != kTfLiteOk) {
+                return 0;
+            }
+        }
+
+        const auto elapsed = std::chrono::steady_clock::now() - start;
+
+        // the first run includes delegate preparation
+        if (run > 0) {
+            times.push_back(std::max<std::uint32_t>(1, std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count()));
+        }
+    }
+
+    std::nth_element(times.begin(), times.begin() + times.size() / 2, times.end());
+    return times[times.size() / 2];
+}
+
+bool NumberClassifier::warm_up() {
+    if (!is_loaded()) {
+        return false;
+    }
+
+    // blank cells, only the shapes matter
+    const std::vector<float> input(MAX_CELLS * INPUT_SIZE * INPUT_SIZE, 0.0f);
+    bool success = true;
+
+    // one interpreter at a time, so scans keep the rest of the pool and
+    // concurrent warm-ups never wait on each other
+    for (std::size_t slot = 0; slot < engine->interpreters.size(); ++slot) {
+        // a busy interpreter is being warmed up by whoever holds it
+        if (!try_checkout(slot)) {
+            continue;
+        }
+
+        Interpreter &interpreter = *engine->interpreters[slot];
+
+        // the largest batch first, the tensor arena then never has to grow
+        for (const int batch_size : {MAX_CELLS, 1}) {
+            if (!resize_batch(interpreter, batch_size)) {
+                continue;
+            }
+
+            TfLiteTensor *input_tensor = TfLiteInterpreterGetInputTensor(interpreter.interpreter, 0);
+            TfLiteTensorCopyFromBuffer(input_tensor, input.data(), batch_size * INPUT_SIZE * INPUT_SIZE * sizeof(float));
+            success &= TfLiteInterpreterInvoke(interpreter.interpreter) == kTfLiteOk;
+        }
+
+        give_back(slot);
+    }
+
+    return success;
+}
+
+BackendSelection NumberClassifier::get_backend() const {
+    return engine->selection;
+}
+
+std::uint64_t NumberClassifier::get_model_hash() const {
+    return engine->model_hash;
+}
+
+InterpreterPoolStatistics NumberClassifier::get_statistics() const {
+    return {static_cast<int>(engine->interpreters.size()), checkouts.load(std::memory_order_relaxed),
+            contended_checkouts.load(std::memory_order_relaxed), peak_in_use.load(std::memory_order_relaxed)};
+}
+
+// Takes the lowest free interpreter without locking. If all are busy it
+// sleeps until one is returned, which only happens with more concurrent
+// scans than interpreters.
+int NumberClassifier::checkout() {
+    std::uint64_t slots = free_slots.load(std::memory_order_relaxed);
+    bool contended = false;
+
+    while (true) {
+        if (slots == 0) {
+            contended = true;
+
+            // give_back reads waiters after publishing its slot, so either
+            // it sees this waiter or the predicate sees the slot
+            std::unique_lock<std::mutex> lock(wait_mutex);
+            waiters.fetch_add(1);
+            slot_returned.wait(lock, [this] { return free_slots.load() != 0; });
+            waiters.fetch_sub(1);
+
+            slots = free_slots.load(std::memory_order_relaxed);
+            continue;
+        }
+
+        const std::uint64_t lowest = slots & (~slots + 1);
+
+        if (free_slots.compare_exchange_weak(slots, slots & ~lowest, std::memory_order_acquire,
+                                             std::memory_order_relaxed)) {
+            checkouts.fetch_add(1, std::memory_order_relaxed);
+            if (contended) contended_checkouts.fetch_add(1, std::memory_order_relaxed);
+
+            const std::uint32_t count = in_use.fetch_add(1, std::memory_order_relaxed) + 1;
+            std::uint32_t peak = peak_in_use.load(std::memory_order_relaxed);
+            while (count > peak && !peak_in_use.compare_exchange_weak(peak, count, std::memory_order_relaxed)) {
+            }
+
+            return Bits::lowest(lowest);
+        }
+    }
+}
+
+// takes the given interpreter if it is free, without waiting
+bool NumberClassifier::try_checkout(int slot) {
+    const std::uint64_t bit = std::uint64_t(1) << slot;
+
+    if (!(free_slots.fetch_and(~bit, std::memory_order_acquire) & bit)) {
+        return false;
+    }
+
+    checkouts.fetch_add(1, std::memory_order_relaxed);
+
+    const std::uint32_t count = in_use.fetch_add(1, std::memory_order_relaxed) + 1;
+    std::uint32_t peak = peak_in_use.load(std::memory_order_relaxed);
+    while (count > peak && !peak_in_use.compare_exchange_weak(peak, count, std::memory_order_relaxed)) {
+    }
+
+    return true;
+}
+
+void NumberClassifier::give_back(int slot) {
+    in_use.fetch_sub(1, std::memory_order_relaxed);
+    free_slots.fetch_or(std::uint64_t(1) << slot);
+
+    // the uncontended path never touches the mutex
+    if (waiters.load() > 0) {
+        // taking the lock orders the notify after the waiter went to sleep
+        { std::lock_guard<std::mutex> lock(wait_mutex); }
+        slot_returned.notify_one();
+    }
+}
+
+void NumberClassifier::predict_numbers(std::vector<Cell> &cells) {
+    if (cells.empty()) {
+        return;
+    }
+
+    // includes waiting for an interpreter, that is part of the scan latency too
+    SCAN_TIMER(PREDICT_NUMBERS);
+
+    if (!is_loaded()) {
+#ifdef __ANDROID__
+        __android_log_print(ANDROID_LOG_ERROR, "predict_numbers", "no model loaded, create the scanner context with a model");
+#endif
+        return;
+    }
+
+    Lease lease(*this);
+    Interpreter &interpreter = lease.get();
+    const int batch_size = cells.size();
+
+    // delegate might not support dynamic batch sizes
+    if (!resize_batch(interpreter, batch_size)) {
+        run_per_cell(interpreter, cells);
+        return;
+    }
+
+    TfLiteTensor *input_tensor = TfLiteInterpreterGetInputTensor(interpreter.interpreter, 0);
+    const TfLiteTensor *output_tensor = TfLiteInterpreterGetOutputTensor(interpreter.interpreter, 0);
+
+    // pack every cell into one input block
+    std::vector<float> input(batch_size * INPUT_SIZE * INPUT_SIZE);
+    for (int i = 0; i < batch_size; ++i) {
+        prepare_input(cells[i].img, input.data() + i * INPUT_SIZE * INPUT_SIZE);
+    }
+
+    std::vector<float> output(batch_size * NUM_CLASSES, 0.0);
+
+    TfLiteTensorCopyFromBuffer(input_tensor, input.data(), input.size() * sizeof(float));
+    TfLiteInterpreterInvoke(interpreter.interpreter);
+    TfLiteTensorCopyToBuffer(output_tensor, output.data(), output.size() * sizeof(float));
+
+    for (int i = 0; i < batch_size; ++i) {
+        assign_number(cells[i], output.data() + i * NUM_CLASSES);
+    }
+}
+
+void NumberClassifier::predict_numbers_per_cell(std::vector<Cell> &cells) {
+    SCAN_TIMER(PREDICT_NUMBERS);
+
+    if (!is_loaded()) {
+        return;
+    }
+
+    Lease lease(*this);
+    Interpreter &interpreter = lease.get();
+
+    if (!resize_batch(interpreter, 1)) {
+        return;
+    }
+
+    run_per_cell(interpreter, cells);
+}
+
+bool NumberClassifier::resize_batch(Interpreter &interpreter, int batch_size) {
+    if (interpreter.batch_size == batch_size) {
+        return true;
+    }
+
+    const int dims[] = {batch_size, INPUT_SIZE, INPUT_SIZE, 1};
+
+    if (TfLiteInterpreterResizeInputTensor(interpreter.interpreter, 0, dims, 4) == kTfLiteOk &&
+        TfLiteInterpreterAllocateTensors(interpreter.interpreter) == kTfLiteOk) {
+        interpreter.batch_size = batch_size;
+        return true;
+    }
+
+    // restore single input shape
+    const int single_dims[] = {1, INPUT_SIZE, INPUT_SIZE, 1};
+    TfLiteInterpreterResizeInputTensor(interpreter.interpreter, 0, single_dims, 4);
+    TfLiteInterpreterAllocateTensors(interpreter.interpreter);
+    interpreter.batch_size = 1;
+
+    return batch_size == 1;
+}
+
+void NumberClassifier::prepare_input(const cv::Mat &img, float *input) {
+    cv::Mat resized;
+    cv::resize(img, resized, cv::Size(INPUT_SIZE, INPUT_SIZE));
+
+    // convert straight into the input block
+    cv::Mat normalized(INPUT_SIZE, INPUT_SIZE, CV_32FC1, input);
+    resized.convertTo(normalized, CV_32FC1, 1.0 / 255.0);
+}
+
+// expects the interpreter to be resized to a batch size of 1
+void NumberClassifier::run_per_cell(Interpreter &interpreter, std::vector<Cell> &cells) {
+    std::vector<float> input(INPUT_SIZE * INPUT_SIZE);
+    std::vector<float> output(NUM_CLASSES, 0.0);
+
+    TfLiteTensor *input_tensor = TfLiteInterpreterGetInputTensor(interpreter.interpreter, 0);
+    const TfLiteTensor *output_tensor = TfLiteInterpreterGetOutputTensor(interpreter.interpreter, 0);
 
     for (Cell &cell : cells) {
-        // prepare cell image
-        cv::resize(cell.img, input, cv::Size(28, 28));
-        input.convertTo(input, CV_32FC1);
-        input /= 255.0;
+        prepare_input(cell.img, input.data());
 
         // load input data into model
-        TfLiteTensorCopyFromBuffer(input_tensor, input.data, input.rows * input.cols * sizeof(float));
+        TfLiteTensorCopyFromBuffer(input_tensor, input.data(), input.size() * sizeof(float));
         // execute inference
-        TfLiteInterpreterInvoke(interpreter);
+        TfLiteInterpreterInvoke(interpreter.interpreter);
         // extract the output tensor data
         TfLiteTensorCopyToBuffer(output_tensor, output.data(), output.size() * sizeof(float));
 
-        // interpret output
-        int number = arg_max(output) + 1;
-        cell.number = number;
+        assign_number(cell, output.data());
+    }
+}
+
+void NumberClassifier::assign_number(Cell &cell, const float *probabilities) {
+    // interpret output
+    int number = arg_max(probabilities, NUM_CLASSES) + 1;
+    cell.number = number;
+    std::copy(probabilities, probabilities + NUM_CLASSES, cell.probabilities.begin());
 
 #ifdef __ANDROID__
 #ifndef NDEBUG
-        float confidence = output[number - 1] * 100;
-        std::string debug = "(" + std::to_string(cell.x) + ", " + std::to_string(cell.y) + ") " + std::to_string(number) + " [" + std::to_string(confidence) + "%]";
-        __android_log_print(ANDROID_LOG_DEBUG, "predict_numbers", "%s", debug.c_str());
+    float confidence = probabilities[number - 1] * 100;
+    std::string debug = "(" + std::to_string(cell.x) + ", " + std::to_string(cell.y) + ") " + std::to_string(number) + " [" + std::to_string(confidence) + "%]";
+    __android_log_print(ANDROID_LOG_DEBUG, "predict_numbers", "%s", debug.c_str());
 #endif
 #endif
-    }
-    // dispose of the model and interpreter objects
-    TfLiteInterpreterDelete(interpreter);
-    TfLiteInterpreterOptionsDelete(options);
-    TfLiteNnapiDelegateDelete(delegate);
-    TfLiteModelDelete(model);
 }
 
-int NumberClassifier::arg_max(std::vector<float> &list) {
-    float max = 0.0;
-    int index = -1;
+// never fails, so every classified cell gets a digit
+int NumberClassifier::arg_max(const float *list, int size) {
+    float max = list[0];
+    int index = 0;
 
-    for (int i = 0; i < list.size(); ++i) {
+    for (int i = 1; i < size; ++i) {
         if (list[i] > max) {
             max = list[i];
             index = i;
@@ -1,17 +1,120 @@
 #ifndef NUMBER_CLASSIFIER_HPP
 #define NUMBER_CLASSIFIER_HPP
 
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <opencv2/core.hpp>
 #include <vector>
 
 #include "../structs/cell.hpp"
 
+struct TfLiteModel;
+
+// Ways to run the model. AUTO benchmarks the others once per process and
+// model and picks the fastest, which is then reused by every later
+// classifier of the same model.
+enum class InferenceBackend {
+    AUTO = -1,
+    CPU,
+    XNNPACK,
+    NNAPI,
+    COUNT
+};
+
+// Backend a classifier runs on and how it got chosen.
+struct BackendSelection {
+    static constexpr int CANDIDATE_COUNT = static_cast<int>(InferenceBackend::COUNT);
+
+    InferenceBackend backend = InferenceBackend::CPU;
+    // cpu threads per interpreter, used by CPU and XNNPACK
+    int threads = 1;
+    // median full grid inference per backend, 0 if unavailable or not measured
+    std::uint32_t benchmark_us[CANDIDATE_COUNT] = {};
+    // taken from an earlier benchmark in this process
+    bool cached = false;
+};
+
+// Usage of the interpreter pool since the model was loaded.
+struct InterpreterPoolStatistics {
+    int pool_size;
+    std::uint32_t checkouts;
+    // checkouts that found every interpreter busy and had to wait
+    std::uint32_t contended_checkouts;
+    // most interpreters checked out at the same time
+    std::uint32_t peak_in_use;
+};
+
+// Digit classifier around one TFLite model. The model is loaded once and
+// shared by a pool of interpreters, so concurrent scans classify in parallel
+// instead of queueing on one interpreter. Instances are independent, so
+// scanner contexts with their own classifier never wait for each other.
 class NumberClassifier {
    public:
-    static void predict_numbers(std::vector<Cell> &cells);
+    // interpreters are bounded by the bits of the free slot mask
+    static constexpr int MAX_POOL_SIZE = 64;
+
+    NumberClassifier();
+    ~NumberClassifier();
+    NumberClassifier(const NumberClassifier &) = delete;
+    NumberClassifier &operator=(const NumberClassifier &) = delete;
+
+    // Builds the model and pool_size interpreters (0 for one per core, at
+    // most 4) on the given backend, replacing any previous ones. Falls back
+    // to CPU if the backend is not available. Loading and releasing must not
+    // overlap predictions.
+    bool load_model(const char *path, InferenceBackend backend = InferenceBackend::AUTO, int pool_size = 0);
+    // same, but from the flatbuffer in memory, which gets copied and kept
+    // for the lifetime of the model
+    bool load_model(const std::uint8_t *data, std::size_t size, InferenceBackend backend = InferenceBackend::AUTO,
+                    int pool_size = 0);
+    void release_model();
+    bool is_loaded() const;
+    // classifies all cells with a single invoke on a [N, 28, 28, 1] batch
+    void predict_numbers(std::vector<Cell> &cells);
+    // classifies one cell per invoke, kept as fallback and for benchmarking
+    void predict_numbers_per_cell(std::vector<Cell> &cells);
+    // Invokes every free interpreter once at the largest and the smallest
+    // batch, so delegate preparation and tensor allocation do not fall into
+    // the first scan. Interpreters busy with a scan are skipped. Counted as
+    // one checkout per warmed interpreter.
+    bool warm_up();
+    InterpreterPoolStatistics get_statistics() const;
+    BackendSelection get_backend() const;
+    // FNV-1a hash of the loaded flatbuffer
+    std::uint64_t get_model_hash() const;
 
    private:
-    NumberClassifier() = delete;
-    static int arg_max(std::vector<float> &list);
+    struct Engine;
+    struct Interpreter;
+    class Lease;
+
+    std::unique_ptr<Engine> engine;
+    // bit i is set while interpreter i is free to be checked out
+    std::atomic<std::uint64_t> free_slots{0};
+    // checkouts that found the pool empty park here until a slot is returned
+    std::mutex wait_mutex;
+    std::condition_variable slot_returned;
+    std::atomic<std::uint32_t> waiters{0};
+    std::atomic<std::uint32_t> checkouts{0};
+    std::atomic<std::uint32_t> contended_checkouts{0};
+    std::atomic<std::uint32_t> in_use{0};
+    std::atomic<std::uint32_t> peak_in_use{0};
+
+    bool create_pool(InferenceBackend backend, int pool_size);
+    static BackendSelection select_backend(const Engine &engine, InferenceBackend backend, int threads);
+    static std::uint32_t benchmark_backend(TfLiteModel *model, InferenceBackend backend, int threads);
+    int checkout();
+    bool try_checkout(int slot);
+    void give_back(int slot);
+    static bool resize_batch(Interpreter &interpreter, int batch_size);
+    static void run_per_cell(Interpreter &interpreter, std::vector<Cell> &cells);
+    static void prepare_input(const cv::Mat &img, float *input);
+    static void assign_number(Cell &cell, const float *probabilities);
+    static int arg_max(const float *list, int size);
 };
 
 #endif
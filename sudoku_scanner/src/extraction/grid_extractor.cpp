@@ -1,27 +1,32 @@
 #include "grid_extractor.hpp"
 
+#include <algorithm>
+#include <cmath>
 #include <cstdint>
 #include <opencv2/imgproc.hpp>
 #include <vector>
 
+#include "../profiling/scan_profiler.hpp"
+#include "../solving/grid_corrector.hpp"
 #include "classification/number_classifier.hpp"
 
 #ifdef DEVMODE
 #include <opencv2/highgui.hpp>
 #endif
 
-const int GRID_SIZE = 450;
-const int CELL_SIZE = GRID_SIZE / 9;
+const int CELL_SIZE = GridExtractor::GRID_SIZE / 9;
+// min amount of points for number
+const int MIN_NUMBER_AREA = 35;
 
-Grid GridExtractor::extract_grid(cv::Mat &img, float x1, float y1, float x2, float y2, float x3, float y3, float x4, float y4) {
+Grid GridExtractor::extract_grid(cv::Mat &img, NumberClassifier &classifier, float x1, float y1, float x2, float y2, float x3, float y3, float x4, float y4, GridDetails *details) {
     cv::Mat thresholded;
-    cv::cvtColor(img, img, cv::COLOR_BGR2GRAY);
     crop_and_transform(img, x1, y1, x2, y2, x3, y3, x4, y4);
-    cv::pyrDown(img, thresholded);
-    cv::pyrUp(thresholded, thresholded);
-    // cv::adaptiveThreshold(thresholded, thresholded, 255, cv::ADAPTIVE_THRESH_MEAN_C, cv::THRESH_BINARY, 69, 20);
-    // cv::adaptiveThreshold(thresholded, thresholded, 255, cv::ADAPTIVE_THRESH_MEAN_C, cv::THRESH_BINARY, 63, 10);
-    cv::adaptiveThreshold(thresholded, thresholded, 255, cv::ADAPTIVE_THRESH_GAUSSIAN_C, cv::THRESH_BINARY, 53, 10);
+    // convert only the warped grid, interpolation and conversion are both
+    // linear so this matches converting the whole source first
+    if (img.channels() > 1) {
+        cv::cvtColor(img, img, cv::COLOR_BGR2GRAY);
+    }
+    binarize(img, thresholded);
 #ifdef DEVMODE
     cv::imshow("transformed + thresholded", thresholded);
 #endif
@@ -29,33 +34,60 @@ Grid GridExtractor::extract_grid(cv::Mat &img, float x1, float y1, float x2, flo
 #ifdef DEVMODE
     cv::imshow("thresholded (grid extraction)", thresholded);
 #endif
-    std::vector<Cell> cells = extract_cells(thresholded, img);
+    std::vector<Cell> cells = extract_cells(thresholded, img, details);
 #ifdef DEVMODE
     cv::imshow("cells", stitch_cells(cells));
 #endif
-    NumberClassifier::predict_numbers(cells);
+    classifier.predict_numbers(cells);
+    correct_numbers(cells);
+
+    if (details) {
+        fill_details(cells, *details);
+    }
 
     return cells_to_grid(cells);
 }
 
 void GridExtractor::crop_and_transform(cv::Mat &img, float x1, float y1, float x2, float y2, float x3, float y3, float x4, float y4) {
+    SCAN_TIMER(WARP);
     std::vector<cv::Point2f> dst_pts{
         cv::Point2f(0, 0),
         cv::Point2f(GRID_SIZE - 1, 0),
         cv::Point2f(0, GRID_SIZE - 1),
         cv::Point2f(GRID_SIZE - 1, GRID_SIZE - 1)};
 
+    // only the source area inside the bounding box gets sampled, with one
+    // pixel margin for the interpolation
+    const int left = std::clamp(static_cast<int>(std::floor(std::min({x1, x2, x3, x4}))) - 1, 0, img.cols - 1);
+    const int top = std::clamp(static_cast<int>(std::floor(std::min({y1, y2, y3, y4}))) - 1, 0, img.rows - 1);
+    const int right = std::min(static_cast<int>(std::ceil(std::max({x1, x2, x3, x4}))) + 2, img.cols);
+    const int bottom = std::min(static_cast<int>(std::ceil(std::max({y1, y2, y3, y4}))) + 2, img.rows);
+    const cv::Rect roi(left, top, std::max(right - left, 1), std::max(bottom - top, 1));
+
     std::vector<cv::Point2f> img_pts{
-        cv::Point2f(x1, y1),
-        cv::Point2f(x2, y2),
-        cv::Point2f(x3, y3),
-        cv::Point2f(x4, y4)};
+        cv::Point2f(x1 - left, y1 - top),
+        cv::Point2f(x2 - left, y2 - top),
+        cv::Point2f(x3 - left, y3 - top),
+        cv::Point2f(x4 - left, y4 - top)};
 
     cv::Mat transformation_matrix = cv::getPerspectiveTransform(img_pts, dst_pts);
-    cv::warpPerspective(img, img, transformation_matrix, cv::Size(GRID_SIZE, GRID_SIZE));
+    // never warp in place, img might wrap a buffer owned by the caller
+    cv::Mat warped;
+    cv::warpPerspective(img(roi), warped, transformation_matrix, cv::Size(GRID_SIZE, GRID_SIZE));
+    img = warped;
+}
+
+void GridExtractor::binarize(const cv::Mat &warped, cv::Mat &binary) {
+    SCAN_TIMER(BINARIZE);
+    cv::pyrDown(warped, binary);
+    cv::pyrUp(binary, binary);
+    // cv::adaptiveThreshold(binary, binary, 255, cv::ADAPTIVE_THRESH_MEAN_C, cv::THRESH_BINARY, 69, 20);
+    // cv::adaptiveThreshold(binary, binary, 255, cv::ADAPTIVE_THRESH_MEAN_C, cv::THRESH_BINARY, 63, 10);
+    cv::adaptiveThreshold(binary, binary, 255, cv::ADAPTIVE_THRESH_GAUSSIAN_C, cv::THRESH_BINARY, 53, 10);
 }
 
 void GridExtractor::remove_grid_lines(cv::Mat &binary) {
+    SCAN_TIMER(REMOVE_GRID_LINES);
     cv::Mat inv;
     cv::bitwise_not(binary, inv);
 
@@ -94,50 +126,51 @@ Grid GridExtractor::cells_to_grid(std::vector<Cell> &cells) {
     return grid;
 }
 
-void GridExtractor::flood_fill_white(cv::Mat &binary, std::vector<cv::Point> &points, int x, int y) {
-    binary.at<uchar>(y, x) = 255;
-    points.push_back(cv::Point(x, y));
+// lets the Sudoku rules overrule doubtful classifications
+void GridExtractor::correct_numbers(std::vector<Cell> &cells) {
+    SCAN_TIMER(CORRECT_NUMBERS);
+    Grid grid = cells_to_grid(cells);
+    std::vector<float> probabilities(grid.size * 9, 0.0f);
+    std::vector<float> blank_confidences(grid.size, 1.0f);
 
-    // four point flood
-    int min_x = std::max(x - 1, 0);
-    int max_x = std::min(x + 1, binary.cols - 1);
-    int min_y = std::max(y - 1, 0);
-    int max_y = std::min(y + 1, binary.rows - 1);
-
-    if (binary.at<uchar>(y, min_x) < 255) {
-        flood_fill_white(binary, points, min_x, y);
-    }
-    if (binary.at<uchar>(y, max_x) < 255) {
-        flood_fill_white(binary, points, max_x, y);
-    }
-    if (binary.at<uchar>(min_y, x) < 255) {
-        flood_fill_white(binary, points, x, min_y);
+    for (const Cell &cell : cells) {
+        std::copy(cell.probabilities.begin(), cell.probabilities.end(), probabilities.begin() + (cell.x + 9 * cell.y) * 9);
+        blank_confidences[cell.x + 9 * cell.y] = cell.blank_confidence;
     }
-    if (binary.at<uchar>(max_y, x) < 255) {
-        flood_fill_white(binary, points, x, max_y);
+
+    GridCorrector::correct(grid.data.get(), probabilities.data(), blank_confidences.data());
+
+    for (Cell &cell : cells) {
+        const std::uint8_t corrected = grid[cell.x + 9 * cell.y];
+        SCAN_COUNT(CORRECTED_CELLS, corrected != cell.number);
+        cell.number = corrected;
     }
 }
 
-bool GridExtractor::extract_number(cv::Mat &binary, cv::Rect &output, cv::Point &center) {
-    const int threshold = 35;  // min amount of points for number
+bool GridExtractor::extract_number(const cv::Mat &labels, const cv::Mat &stats, std::vector<char> &visited, cv::Rect &output, cv::Point &center) {
     const int scan_size = CELL_SIZE / 3;
 
     std::vector<cv::Rect> connected_areas;
 
     for (int y = center.y - scan_size / 2; y < center.y + scan_size / 2; ++y) {
         for (int x = center.x - scan_size / 2; x < center.x + scan_size / 2; ++x) {
-            if (binary.at<uchar>(y, x) == 255) {
+            const int label = labels.at<int>(y, x);
+
+            // white background or component already looked at
+            if (label == 0 || visited[label]) {
                 continue;
             }
 
-            std::vector<cv::Point> points;
-            flood_fill_white(binary, points, x, y);
+            visited[label] = true;
 
-            if (points.size() < threshold) {
+            if (stats.at<int>(label, cv::CC_STAT_AREA) < MIN_NUMBER_AREA) {
                 continue;
             }
 
-            cv::Rect bb = cv::boundingRect(points);
+            cv::Rect bb(stats.at<int>(label, cv::CC_STAT_LEFT),
+                        stats.at<int>(label, cv::CC_STAT_TOP),
+                        stats.at<int>(label, cv::CC_STAT_WIDTH),
+                        stats.at<int>(label, cv::CC_STAT_HEIGHT));
 
             if (bb.height < 0.2 * CELL_SIZE || bb.height > 0.9 * CELL_SIZE ||
                 bb.width < 0.1 * CELL_SIZE || bb.width > 0.8 * CELL_SIZE) {
@@ -148,13 +181,6 @@ bool GridExtractor::extract_number(cv::Mat &binary, cv::Rect &output, cv::Point
         }
     }
 
-#ifdef DEVMODE
-    // cv::Point offset(scan_size / 2, scan_size / 2);
-    // cv::rectangle(binary, center - offset, center + offset, cv::Scalar(0, 0, 0));
-    // cv::imshow("flood fill", binary);
-    // cv::waitKey();
-#endif
-
     if (connected_areas.empty()) {
         return false;
     }
@@ -197,27 +223,60 @@ void GridExtractor::make_square(cv::Rect &rect, int pad_size) {
     rect = cv::Rect(top_left, bottom_right);
 }
 
-std::vector<Cell> GridExtractor::extract_cells(cv::Mat &binary, cv::Mat &img) {
+std::vector<Cell> GridExtractor::extract_cells(cv::Mat &binary, cv::Mat &img, GridDetails *details) {
+    SCAN_TIMER(EXTRACT_CELLS);
     std::vector<Cell> cells;
 
+    // label black (ink) components of the whole grid in a single pass
+    cv::Mat ink, labels, stats, centroids;
+    cv::bitwise_not(binary, ink);
+    int label_count = cv::connectedComponentsWithStats(ink, labels, stats, centroids, 4, CV_32S);
+    // each component belongs to the first cell that touches it
+    std::vector<char> visited(label_count, false);
+
     for (std::uint8_t y = 0; y < 9; ++y) {
         for (std::uint8_t x = 0; x < 9; ++x) {
             cv::Rect bounding_box;
             cv::Point center(x * CELL_SIZE + CELL_SIZE / 2, y * CELL_SIZE + CELL_SIZE / 2);
-            bool has_number = extract_number(binary, bounding_box, center);
+            bool has_number = extract_number(labels, stats, visited, bounding_box, center);
+            float blank_confidence = 1.0f;
+
+            if (has_number || details) {
+                // ink in the central half of the cell, where digits sit
+                cv::Rect central(center.x - CELL_SIZE / 4, center.y - CELL_SIZE / 4, CELL_SIZE / 2, CELL_SIZE / 2);
+                float ink_ratio = static_cast<float>(cv::countNonZero(ink(central))) / MIN_NUMBER_AREA;
+                blank_confidence = 1.0f - std::min(ink_ratio, 1.0f);
+            }
+
+            if (details) {
+                (*details)[x + 9 * y].blank_confidence = blank_confidence;
+            }
 
             if (has_number) {
                 // cv::rectangle(img, bounding_box, cv::Scalar(0, 255, 0));  // debug TODO delete
+                cv::Rect number_box = bounding_box;
                 make_square(bounding_box, 2);
                 cv::Mat number_img = img(bounding_box);
-                cells.emplace_back(number_img, x, y);
+                cells.emplace_back(number_img, x, y, number_box);
+                cells.back().blank_confidence = blank_confidence;
             }
         }
     }
 
+    SCAN_COUNT(CELLS, cells.size());
+
     return cells;
 }
 
+void GridExtractor::fill_details(const std::vector<Cell> &cells, GridDetails &details) {
+    for (const Cell &cell : cells) {
+        CellDetails &cell_details = details[cell.x + 9 * cell.y];
+        cell_details.number = cell.number;
+        cell_details.probabilities = cell.probabilities;
+        cell_details.bounding_box = cell.bounding_box;
+    }
+}
+
 // only for debug
 cv::Mat GridExtractor::stitch_cells(std::vector<Cell> &cells) {
     cv::Mat stitched = cv::Mat::zeros(GRID_SIZE, GRID_SIZE, CV_8UC1);
@@ -7,20 +7,31 @@
 
 #include "structs/cell.hpp"
 #include "structs/grid.hpp"
+#include "structs/grid_details.hpp"
+
+class NumberClassifier;
 
 class GridExtractor {
    public:
-    static Grid extract_grid(cv::Mat &img, float x1, float y1, float x2, float y2, float x3, float y3, float x4, float y4);
+    // side length of the warped grid
+    static constexpr int GRID_SIZE = 450;
 
-   private:
-    GridExtractor() = delete;
+    // details, if given, get everything known about each cell
+    static Grid extract_grid(cv::Mat &img, NumberClassifier &classifier, float x1, float y1, float x2, float y2, float x3, float y3, float x4, float y4, GridDetails *details = nullptr);
+
+    // stages of extract_grid, public to benchmark them separately
     static void crop_and_transform(cv::Mat &img, float x1, float y1, float x2, float y2, float x3, float y3, float x4, float y4);
+    static void binarize(const cv::Mat &warped, cv::Mat &binary);
     static void remove_grid_lines(cv::Mat &binary);
+    static std::vector<Cell> extract_cells(cv::Mat &binary, cv::Mat &img, GridDetails *details = nullptr);
+
+   private:
+    GridExtractor() = delete;
     static Grid cells_to_grid(std::vector<Cell> &cells);
-    static void flood_fill_white(cv::Mat &binary, std::vector<cv::Point> &points, int x, int y);
-    static bool extract_number(cv::Mat &binary, cv::Rect &output, cv::Point &center);
+    static void correct_numbers(std::vector<Cell> &cells);
+    static bool extract_number(const cv::Mat &labels, const cv::Mat &stats, std::vector<char> &visited, cv::Rect &output, cv::Point &center);
     static void make_square(cv::Rect &rect, int pad_size);
-    static std::vector<Cell> extract_cells(cv::Mat &binary, cv::Mat &img);
+    static void fill_details(const std::vector<Cell> &cells, GridDetails &details);
     static cv::Mat stitch_cells(std::vector<Cell> &cells);  // debug
 };
 
@@ -1,6 +1,7 @@
 #ifndef CELL_HPP
 #define CELL_HPP
 
+#include <array>
 #include <cstdint>
 #include <opencv2/core.hpp>
 
@@ -9,8 +10,15 @@ struct Cell {
     const std::uint8_t x;
     const std::uint8_t y;
     std::uint8_t number = 0;
+    // classifier output, one per digit
+    std::array<float, 9> probabilities{};
+    // 1 without any ink around the cell center, 0 with at least a digit's worth
+    float blank_confidence = 0.0f;
+    // digit in warped grid coordinates
+    const cv::Rect bounding_box;
 
-    Cell(const cv::Mat &img, const std::uint8_t x, const std::uint8_t y) : img(img), x(x), y(y) {}
+    Cell(const cv::Mat &img, const std::uint8_t x, const std::uint8_t y, const cv::Rect &bounding_box = cv::Rect())
+        : img(img), x(x), y(y), bounding_box(bounding_box) {}
 };
 
 #endif
@@ -0,0 +1,21 @@
+#ifndef GRID_DETAILS_HPP
+#define GRID_DETAILS_HPP
+
+#include <array>
+#include <cstdint>
+#include <opencv2/core.hpp>
+
+struct CellDetails {
+    std::uint8_t number = 0;
+    // classifier output, one per digit, all 0 for blank cells
+    std::array<float, 9> probabilities{};
+    // digit in warped grid coordinates, empty for blank cells
+    cv::Rect bounding_box;
+    // 1 without any ink around the cell center, 0 with at least a digit's worth
+    float blank_confidence = 1.0f;
+};
+
+// row-major, like Grid
+using GridDetails = std::array<CellDetails, 81>;
+
+#endif
@@ -0,0 +1,73 @@
+#include "scan_profiler.hpp"
+
+namespace {
+// stage a counter belongs to, it is published together with it
+const ScanStage COUNTER_STAGES[ScanRecord::COUNTER_COUNT] = {
+    ScanStage::LOCATE_GRID,      // THRESHOLD_PASSES
+    ScanStage::LOCATE_GRID,      // QUADRILATERALS
+    ScanStage::LOCATE_GRID,      // REJECTED_QUADRILATERALS
+    ScanStage::EXTRACT_CELLS,    // CELLS
+    ScanStage::CORRECT_NUMBERS,  // CORRECTED_CELLS
+};
+
+thread_local ScanRecord current;
+thread_local int trace_depth = 0;
+thread_local ScanRecord finished;
+}  // namespace
+
+void ScanHistory::merge(const ScanRecord &trace) {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    for (int i = 0; i < ScanRecord::STAGE_COUNT; ++i) {
+        if (trace.stage_calls[i] == 0) continue;
+        record.stage_nanoseconds[i] = trace.stage_nanoseconds[i];
+        record.stage_calls[i] = trace.stage_calls[i];
+    }
+
+    for (int i = 0; i < ScanRecord::COUNTER_COUNT; ++i) {
+        if (trace.stage_calls[static_cast<int>(COUNTER_STAGES[i])] == 0) continue;
+        record.counters[i] = trace.counters[i];
+    }
+}
+
+ScanRecord ScanHistory::last() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return record;
+}
+
+void ScanProfiler::add_time(ScanStage stage, std::uint64_t nanoseconds) {
+    const int index = static_cast<int>(stage);
+    current.stage_nanoseconds[index] += nanoseconds;
+    current.stage_calls[index]++;
+}
+
+void ScanProfiler::count(ScanCounter counter, std::uint32_t amount) {
+    current.counters[static_cast<int>(counter)] += amount;
+}
+
+void ScanProfiler::begin_trace() {
+    if (trace_depth++ == 0) {
+        current = ScanRecord();
+    }
+}
+
+bool ScanProfiler::end_trace() {
+    if (--trace_depth > 0) {
+        return false;
+    }
+
+    finished = current;
+    return true;
+}
+
+ScanRecord ScanProfiler::last_trace() {
+    return finished;
+}
+
+bool ScanProfiler::is_enabled() {
+#ifdef SCAN_STATS
+    return true;
+#else
+    return false;
+#endif
+}
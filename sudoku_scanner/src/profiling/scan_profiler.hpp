@@ -0,0 +1,122 @@
+#ifndef SCAN_PROFILER_HPP
+#define SCAN_PROFILER_HPP
+
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+
+// Timings and counters of a scan. Built with SCAN_STATS, SCAN_TIMER and
+// SCAN_COUNT record into a record of the calling thread, which SCAN_TRACE
+// (placed in every scanning FFI entry point) starts and, on return, merges
+// into the scan history of the context. Without SCAN_STATS the macros
+// compile to nothing.
+//
+// Work that cv::parallel_for_ moves to other threads (e.g. the parallel
+// detection cascade) is only partly counted.
+
+enum class ScanStage {
+    DECODE,
+    PREPROCESS,
+    LOCATE_GRID,
+    WARP,
+    BINARIZE,
+    REMOVE_GRID_LINES,
+    EXTRACT_CELLS,
+    PREDICT_NUMBERS,
+    CORRECT_NUMBERS,
+    COUNT
+};
+
+enum class ScanCounter {
+    THRESHOLD_PASSES,
+    QUADRILATERALS,
+    REJECTED_QUADRILATERALS,
+    CELLS,
+    CORRECTED_CELLS,
+    COUNT
+};
+
+struct ScanRecord {
+    static constexpr int STAGE_COUNT = static_cast<int>(ScanStage::COUNT);
+    static constexpr int COUNTER_COUNT = static_cast<int>(ScanCounter::COUNT);
+
+    std::uint64_t stage_nanoseconds[STAGE_COUNT] = {};
+    std::uint32_t stage_calls[STAGE_COUNT] = {};
+    std::uint32_t counters[COUNTER_COUNT] = {};
+};
+
+// Latest scans of one scanner context. Only stages that ran in a trace
+// replace older values, so a detection followed by an extraction covers the
+// whole scan.
+class ScanHistory {
+   public:
+    void merge(const ScanRecord &record);
+    ScanRecord last() const;
+
+   private:
+    mutable std::mutex mutex;
+    ScanRecord record;
+};
+
+class ScanProfiler {
+   public:
+    ScanProfiler() = delete;
+    static void add_time(ScanStage stage, std::uint64_t nanoseconds);
+    static void count(ScanCounter counter, std::uint32_t amount);
+    // nested traces (entry points calling each other) share the outer
+    // record, end_trace returns true once the outermost one finished
+    static void begin_trace();
+    static bool end_trace();
+    // record of the latest outermost trace on the calling thread, unaffected
+    // by scans on other threads
+    static ScanRecord last_trace();
+    static bool is_enabled();
+};
+
+#ifdef SCAN_STATS
+
+class ScopedStageTimer {
+   public:
+    explicit ScopedStageTimer(ScanStage stage) : stage(stage), start(std::chrono::steady_clock::now()) {}
+
+    ~ScopedStageTimer() {
+        auto elapsed = std::chrono::steady_clock::now() - start;
+        ScanProfiler::add_time(stage, std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+    }
+
+   private:
+    const ScanStage stage;
+    const std::chrono::steady_clock::time_point start;
+};
+
+class ScopedScanTrace {
+   public:
+    explicit ScopedScanTrace(ScanHistory &history) : history(history) {
+        ScanProfiler::begin_trace();
+    }
+
+    ~ScopedScanTrace() {
+        if (ScanProfiler::end_trace()) {
+            history.merge(ScanProfiler::last_trace());
+        }
+    }
+
+   private:
+    ScanHistory &history;
+};
+
+#define SCAN_STATS_CONCAT_(a, b) a##b
+#define SCAN_STATS_CONCAT(a, b) SCAN_STATS_CONCAT_(a, b)
+#define SCAN_TIMER(stage) ScopedStageTimer SCAN_STATS_CONCAT(scan_timer_, __LINE__)(ScanStage::stage)
+#define SCAN_COUNT(counter, amount) ScanProfiler::count(ScanCounter::counter, amount)
+#define SCAN_TRACE(history) ScopedScanTrace SCAN_STATS_CONCAT(scan_trace_, __LINE__)(history)
+
+#else
+
+#define SCAN_TIMER(stage)
+#define SCAN_COUNT(counter, amount)
+#define SCAN_TRACE(history)
+
+#endif
+
+#endif
@@ -0,0 +1,209 @@
+#include "grid_corrector.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <vector>
+
+#include "sudoku_solver.hpp"
+
+namespace {
+// cells below this confidence may be changed
+const float LOW_CONFIDENCE = 0.9f;
+// alternative digits need at least this share of the top digit's
+// probability, a digit read with far more certainty is never overruled
+const float MIN_ALTERNATIVE_RATIO = 0.25f;
+// filled cells with this little ink may also turn out blank
+const float MIN_BLANK_CONFIDENCE = 0.5f;
+const int MAX_ALTERNATIVES = 3;
+const std::size_t MAX_CELLS = 8;
+// solution counts per correction, bounds the worst case latency
+const int MAX_EVALUATIONS = 500;
+
+const float NO_SCORE = -std::numeric_limits<float>::infinity();
+
+// a cell that may be changed, with its most probable digits
+struct Candidate {
+    int index;
+    float confidence;
+    int count = 0;
+    // most probable digits, 0 for blank
+    std::array<std::uint8_t, MAX_ALTERNATIVES + 1> digits{};
+    // log probabilities of digits
+    std::array<float, MAX_ALTERNATIVES + 1> scores{};
+};
+
+float log_probability(float probability) {
+    return std::log(std::max(probability, 1e-6f));
+}
+
+bool is_peer(int first, int second) {
+    return first / 9 == second / 9 || first % 9 == second % 9 ||
+           (first / 27 == second / 27 && (first % 9) / 3 == (second % 9) / 3);
+}
+
+// marks filled cells that share a unit with a cell of the same digit
+std::array<bool, 81> find_conflicts(const std::uint8_t *grid) {
+    std::array<bool, 81> conflicts{};
+
+    for (int i = 0; i < 81; ++i) {
+        if (!grid[i]) continue;
+        for (int j = i + 1; j < 81; ++j) {
+            if (grid[j] == grid[i] && is_peer(i, j)) {
+                conflicts[i] = true;
+                conflicts[j] = true;
+            }
+        }
+    }
+
+    return conflicts;
+}
+
+Candidate make_candidate(int index, const float *probabilities, float blank_confidence) {
+    Candidate candidate;
+    candidate.index = index;
+
+    std::array<int, 9> order;
+    std::iota(order.begin(), order.end(), 0);
+    std::partial_sort(order.begin(), order.begin() + MAX_ALTERNATIVES, order.end(),
+                      [&](int a, int b) { return probabilities[a] > probabilities[b]; });
+
+    candidate.confidence = probabilities[order[0]];
+
+    for (int i = 0; i < MAX_ALTERNATIVES; ++i) {
+        if (i > 0 && probabilities[order[i]] < MIN_ALTERNATIVE_RATIO * candidate.confidence) break;
+
+        candidate.digits[candidate.count] = order[i] + 1;
+        candidate.scores[candidate.count] = log_probability(probabilities[order[i]]);
+        ++candidate.count;
+    }
+
+    // ink the classifier took for a digit, e.g. a speck or a grid line rest
+    if (blank_confidence >= MIN_BLANK_CONFIDENCE) {
+        candidate.digits[candidate.count] = 0;
+        candidate.scores[candidate.count] = log_probability(blank_confidence);
+        ++candidate.count;
+    }
+
+    // best first, the search bound relies on it
+    for (int i = 1; i < candidate.count; ++i) {
+        for (int j = i; j > 0 && candidate.scores[j] > candidate.scores[j - 1]; --j) {
+            std::swap(candidate.scores[j], candidate.scores[j - 1]);
+            std::swap(candidate.digits[j], candidate.digits[j - 1]);
+        }
+    }
+
+    return candidate;
+}
+
+// branch and bound over the alternatives of every candidate, best first
+class Search {
+   public:
+    Search(const std::uint8_t *grid, const std::vector<Candidate> &doubtful) : candidates(doubtful) {
+        std::copy(grid, grid + 81, current.begin());
+        for (const Candidate &candidate : candidates) current[candidate.index] = 0;
+
+        // best score still reachable from each depth
+        bounds.assign(candidates.size() + 1, 0.0f);
+        for (int i = candidates.size() - 1; i >= 0; --i) {
+            bounds[i] = bounds[i + 1] + candidates[i].scores[0];
+        }
+    }
+
+    void run() {
+        visit(0, 0.0f);
+    }
+
+    float unique_score = NO_SCORE;
+    std::array<std::uint8_t, 81> unique_grid{};
+    // best grid with several solutions, used if the input has none
+    float solvable_score = NO_SCORE;
+    std::array<std::uint8_t, 81> solvable_grid{};
+
+   private:
+    const std::vector<Candidate> candidates;
+    std::vector<float> bounds;
+    std::array<std::uint8_t, 81> current;
+    int evaluations = 0;
+
+    bool fits(int index, std::uint8_t digit) const {
+        for (int i = 0; i < 81; ++i) {
+            if (current[i] == digit && i != index && is_peer(i, index)) return false;
+        }
+        return true;
+    }
+
+    void visit(std::size_t depth, float score) {
+        if (evaluations >= MAX_EVALUATIONS || score + bounds[depth] <= unique_score) return;
+
+        if (depth == candidates.size()) {
+            ++evaluations;
+            const int solutions = SudokuSolver::count_solutions(current.data(), 2);
+
+            if (solutions == 1) {
+                unique_score = score;
+                unique_grid = current;
+            } else if (solutions > 1 && score > solvable_score) {
+                solvable_score = score;
+                solvable_grid = current;
+            }
+            return;
+        }
+
+        const Candidate &candidate = candidates[depth];
+
+        for (int i = 0; i < candidate.count; ++i) {
+            if (candidate.digits[i] && !fits(candidate.index, candidate.digits[i])) continue;
+
+            current[candidate.index] = candidate.digits[i];
+            visit(depth + 1, score + candidate.scores[i]);
+            current[candidate.index] = 0;
+        }
+    }
+};
+}  // namespace
+
+bool GridCorrector::correct(std::uint8_t *grid, const float *probabilities, const float *blank_confidences) {
+    const int solutions = SudokuSolver::count_solutions(grid, 2);
+    if (solutions == 1) return true;
+
+    const std::array<bool, 81> conflicts = find_conflicts(grid);
+    std::vector<Candidate> candidates;
+
+    for (int i = 0; i < 81; ++i) {
+        if (!grid[i]) continue;
+
+        Candidate candidate = make_candidate(i, probabilities + i * 9, blank_confidences[i]);
+        // a cell without any alternative stays as read
+        if ((conflicts[i] || candidate.confidence < LOW_CONFIDENCE) && candidate.count > 1) {
+            candidates.push_back(candidate);
+        }
+    }
+
+    if (candidates.empty()) return false;
+
+    // conflicting cells first, then the least confident ones
+    std::sort(candidates.begin(), candidates.end(), [&](const Candidate &a, const Candidate &b) {
+        if (conflicts[a.index] != conflicts[b.index]) return conflicts[a.index];
+        return a.confidence < b.confidence;
+    });
+    if (candidates.size() > MAX_CELLS) candidates.resize(MAX_CELLS);
+
+    Search search(grid, candidates);
+    search.run();
+
+    if (search.unique_score != NO_SCORE) {
+        std::copy(search.unique_grid.begin(), search.unique_grid.end(), grid);
+        return true;
+    }
+
+    // a solvable grid beats one that contradicts itself, but a grid with
+    // several solutions is kept as read
+    if (solutions == 0 && search.solvable_score != NO_SCORE) {
+        std::copy(search.solvable_grid.begin(), search.solvable_grid.end(), grid);
+    }
+
+    return false;
+}
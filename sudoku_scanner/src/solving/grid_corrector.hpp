@@ -0,0 +1,26 @@
+#ifndef GRID_CORRECTOR_HPP
+#define GRID_CORRECTOR_HPP
+
+#include <cstdint>
+
+// Fixes misread digits of a scanned grid with the Sudoku rules. If the most
+// probable digits break a row, column or box or leave more than one solution,
+// the most probable assignment of the doubtful (low confidence or
+// conflicting) cells that leads to exactly one solution is searched. Only
+// digits with a probability close to the top one, or blank for cells with
+// little ink, are tried, so a plausible grid is never forced into a wrong
+// unique one.
+class GridCorrector {
+   public:
+    GridCorrector() = delete;
+
+    // grid holds 81 values (0 for blank cells), probabilities 81 * 9 values
+    // with the classifier output of every filled cell and blank_confidences
+    // 81 values with how likely each filled cell is blank after all. Corrects
+    // grid in place and returns true if it has exactly one solution
+    // afterwards. A grid with several solutions is kept as read unless a
+    // plausible correction makes it unique.
+    static bool correct(std::uint8_t *grid, const float *probabilities, const float *blank_confidences);
+};
+
+#endif
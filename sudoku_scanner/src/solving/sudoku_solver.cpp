@@ -0,0 +1,172 @@
+#include "sudoku_solver.hpp"
+
+#include <algorithm>
+#include <array>
+
+#include "../utils/bits.hpp"
+
+namespace {
+const std::uint16_t ALL_DIGITS = 0x1FF;
+const int UNIT_COUNT = 27;
+
+// rows, columns and boxes as lists of cell indices
+std::array<std::array<std::uint8_t, 9>, UNIT_COUNT> make_units() {
+    std::array<std::array<std::uint8_t, 9>, UNIT_COUNT> units{};
+    for (int i = 0; i < 9; ++i) {
+        for (int j = 0; j < 9; ++j) {
+            units[i][j] = i * 9 + j;
+            units[9 + i][j] = j * 9 + i;
+            units[18 + i][j] = (i / 3) * 27 + (i % 3) * 3 + (j / 3) * 9 + j % 3;
+        }
+    }
+    return units;
+}
+
+const auto UNITS = make_units();
+
+inline int box_of(int index) {
+    return (index / 27) * 3 + (index % 9) / 3;
+}
+
+inline int bit_count(std::uint16_t mask) {
+    return Bits::count(mask);
+}
+
+inline int lowest_digit(std::uint16_t mask) {
+    return Bits::lowest(mask) + 1;
+}
+}  // namespace
+
+// digits in use per unit as bitmasks (bit 0 is digit 1), copied on every branch
+struct SudokuSolver::Board {
+    std::uint16_t rows[9] = {};
+    std::uint16_t cols[9] = {};
+    std::uint16_t boxes[9] = {};
+    std::uint8_t cells[81] = {};
+
+    std::uint16_t candidates(int index) const {
+        return ~(rows[index / 9] | cols[index % 9] | boxes[box_of(index)]) & ALL_DIGITS;
+    }
+
+    bool place(int index, int digit) {
+        const std::uint16_t bit = 1 << (digit - 1);
+        if (!(candidates(index) & bit)) return false;
+
+        rows[index / 9] |= bit;
+        cols[index % 9] |= bit;
+        boxes[box_of(index)] |= bit;
+        cells[index] = digit;
+        return true;
+    }
+};
+
+bool SudokuSolver::solve(const std::uint8_t *input, std::uint8_t *output) {
+    Board board;
+    if (!load(input, board)) return false;
+
+    return search(board, 1, output) == 1;
+}
+
+int SudokuSolver::count_solutions(const std::uint8_t *input, int limit) {
+    if (limit <= 0) return 0;
+
+    Board board;
+    if (!load(input, board)) return 0;
+
+    return search(board, limit, nullptr);
+}
+
+bool SudokuSolver::load(const std::uint8_t *input, Board &board) {
+    for (int i = 0; i < 81; ++i) {
+        if (input[i] == 0) continue;
+        if (input[i] > 9 || !board.place(i, input[i])) return false;
+    }
+    return true;
+}
+
+// fills in naked and hidden singles until nothing changes, false on contradiction
+bool SudokuSolver::propagate(Board &board) {
+    bool changed = true;
+
+    while (changed) {
+        changed = false;
+
+        // naked singles: only one digit left for a cell
+        for (int i = 0; i < 81; ++i) {
+            if (board.cells[i]) continue;
+
+            const std::uint16_t candidates = board.candidates(i);
+            if (!candidates) return false;
+            if (bit_count(candidates) == 1) {
+                board.place(i, lowest_digit(candidates));
+                changed = true;
+            }
+        }
+
+        // hidden singles: only one cell left for a digit in a unit
+        for (const auto &unit : UNITS) {
+            std::uint16_t placed = 0;
+            std::uint16_t once = 0;
+            std::uint16_t more = 0;
+
+            for (const auto index : unit) {
+                if (board.cells[index]) {
+                    placed |= 1 << (board.cells[index] - 1);
+                } else {
+                    const std::uint16_t candidates = board.candidates(index);
+                    more |= once & candidates;
+                    once |= candidates;
+                }
+            }
+
+            if ((placed | once) != ALL_DIGITS) return false;
+
+            for (std::uint16_t hidden = once & ~more; hidden; hidden &= hidden - 1) {
+                const std::uint16_t bit = hidden & -hidden;
+                const auto index = std::find_if(unit.begin(), unit.end(), [&](std::uint8_t i) {
+                    return !board.cells[i] && (board.candidates(i) & bit);
+                });
+                // an earlier single of this unit took the only cell
+                if (index == unit.end() || !board.place(*index, lowest_digit(bit))) return false;
+                changed = true;
+            }
+        }
+    }
+
+    return true;
+}
+
+// depth first search branching on the cell with the fewest candidates,
+// returns the number of solutions found (at most limit), the first one is
+// written into output
+int SudokuSolver::search(Board &board, int limit, std::uint8_t *output) {
+    if (!propagate(board)) return 0;
+
+    int next = -1;
+    int fewest = 10;
+
+    for (int i = 0; i < 81 && fewest > 2; ++i) {
+        if (board.cells[i]) continue;
+
+        const int count = bit_count(board.candidates(i));
+        if (count < fewest) {
+            next = i;
+            fewest = count;
+        }
+    }
+
+    if (next == -1) {
+        if (output) std::copy(board.cells, board.cells + 81, output);
+        return 1;
+    }
+
+    int found = 0;
+
+    for (std::uint16_t candidates = board.candidates(next); candidates && found < limit; candidates &= candidates - 1) {
+        Board branch = board;
+        branch.place(next, lowest_digit(candidates));
+        found += search(branch, limit - found, found == 0 ? output : nullptr);
+    }
+
+    return found;
+}
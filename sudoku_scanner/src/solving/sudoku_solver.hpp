@@ -0,0 +1,27 @@
+#ifndef SUDOKU_SOLVER_HPP
+#define SUDOKU_SOLVER_HPP
+
+#include <cstdint>
+
+// Grids are 81 values in row-major order, 0 marks an empty cell.
+class SudokuSolver {
+   public:
+    SudokuSolver() = delete;
+
+    // writes the first solution found into output, returns false if the grid
+    // is invalid or has no solution (output is left untouched then)
+    static bool solve(const std::uint8_t *input, std::uint8_t *output);
+
+    // number of solutions of input, stops searching once limit is reached
+    // (a limit of 2 is enough to tell unique grids apart), 0 for limit <= 0
+    static int count_solutions(const std::uint8_t *input, int limit);
+
+   private:
+    struct Board;
+
+    static bool load(const std::uint8_t *input, Board &board);
+    static bool propagate(Board &board);
+    static int search(Board &board, int limit, std::uint8_t *output);
+};
+
+#endif
@@ -1,30 +1,131 @@
 #include "sudoku_scanner.h"
 
+#include <algorithm>
 #include <cassert>
+#include <cmath>
 #include <cstdint>
+#include <iterator>
+#include <limits>
+#include <memory>
 #include <new>
-#include <opencv2/imgcodecs.hpp>
+#include <string>
 #include <opencv2/imgproc.hpp>
 #include <vector>
 
+#include "decoding/image_decoder.hpp"
 #include "detection/grid_detector.hpp"
-#include "dictionary/dictionary.hpp"
+#include "detection/grid_tracker.hpp"
+#include "extraction/classification/number_classifier.hpp"
 #include "extraction/grid_extractor.hpp"
 #include "extraction/structs/cell.hpp"
 #include "extraction/structs/grid.hpp"
+#include "profiling/scan_profiler.hpp"
+#include "solving/sudoku_solver.hpp"
 
-BoundingBox *detect_grid(const char *path) {
-    BoundingBox *bb_ptr = new BoundingBox();
-    cv::Mat mat = cv::imread(path);
-    int width = mat.size().width;
-    int height = mat.size().height;
+static_assert(THRESHOLD_SETTING_COUNT == CascadeStatistics::SETTING_COUNT, "threshold setting count out of sync");
+static_assert(WARPED_GRID_SIZE == GridExtractor::GRID_SIZE, "warped grid size out of sync");
+static_assert(BACKEND_COUNT == BackendSelection::CANDIDATE_COUNT, "backend count out of sync");
+static_assert(BACKEND_AUTO == static_cast<int>(InferenceBackend::AUTO) && BACKEND_CPU == static_cast<int>(InferenceBackend::CPU) &&
+                  BACKEND_XNNPACK == static_cast<int>(InferenceBackend::XNNPACK) && BACKEND_NNAPI == static_cast<int>(InferenceBackend::NNAPI),
+              "backend ids out of sync");
 
-    if (width == 0 || height == 0) {
-        return bb_ptr;
+// owns everything scans share, see scanner_create
+struct ScannerContext {
+    NumberClassifier classifier;
+    CascadeState cascade;
+    // timings of the latest scans on this context
+    ScanHistory history;
+};
+
+struct ScanSession {
+    ScannerContext *context;
+    // decoded image, converted to grayscale once
+    cv::Mat gray;
+    // downscaled detection image, built on first detection
+    cv::Mat detection_image;
+};
+
+struct TrackingSession {
+    ScannerContext *context;
+    GridTracker tracker;
+};
+
+namespace {
+
+// Detection works at a fixed low resolution, so a big photo is downscaled by
+// the JPEG decoder already.
+int detection_factor(const cv::Size &size) {
+    return ImageDecoder::reduction_factor(std::min(size.width, size.height), GridDetector::RESOLUTION);
+}
+
+// The grid is warped to a fixed size, so only decode as much resolution as
+// the shortest grid edge needs for that.
+int extraction_factor(const cv::Size &size, const BoundingBox *bounding_box) {
+    const Offset corners[] = {
+        bounding_box->top_left,
+        bounding_box->top_right,
+        bounding_box->bottom_right,
+        bounding_box->bottom_left};
+
+    double shortest_edge = std::numeric_limits<double>::max();
+
+    for (int i = 0; i < 4; ++i) {
+        const double dx = corners[(i + 1) % 4].x - corners[i].x;
+        const double dy = corners[(i + 1) % 4].y - corners[i].y;
+        // header size ignores EXIF orientation, so assume the worse of both
+        const double length = std::min(std::hypot(dx * size.width, dy * size.height),
+                                       std::hypot(dx * size.height, dy * size.width));
+        shortest_edge = std::min(shortest_edge, length);
+    }
+
+    return ImageDecoder::reduction_factor(shortest_edge, GridExtractor::GRID_SIZE);
+}
+
+// grayscale view on the Y plane of the frame
+cv::Mat frame_to_gray(const YuvFrame *frame) {
+    SCAN_TIMER(DECODE);
+    if (!frame || !frame->y_plane || frame->width <= 0 || frame->height <= 0) {
+        return cv::Mat();
+    }
+
+    // rows shorter than the width would make cv::Mat throw
+    if (frame->y_row_stride > 0 && frame->y_row_stride < frame->width) {
+        return cv::Mat();
+    }
+
+    const std::size_t step = frame->y_row_stride > 0 ? frame->y_row_stride : cv::Mat::AUTO_STEP;
+    cv::Mat gray(frame->height, frame->width, CV_8UC1, const_cast<std::uint8_t *>(frame->y_plane), step);
+
+    // rotate into separate Mat, so the frame buffer stays untouched
+    cv::Mat rotated;
+    switch (frame->rotation) {
+        case 90:
+            cv::rotate(gray, rotated, cv::ROTATE_90_CLOCKWISE);
+            return rotated;
+        case 180:
+            cv::rotate(gray, rotated, cv::ROTATE_180);
+            return rotated;
+        case 270:
+            cv::rotate(gray, rotated, cv::ROTATE_90_COUNTERCLOCKWISE);
+            return rotated;
+        default:
+            return gray;
+    }
+}
+
+ScanSession *open_session(ScannerContext *context, const cv::Mat &gray) {
+    if (gray.empty()) {
+        return nullptr;
     }
 
-    std::vector<cv::Point> points = GridDetector::detect_grid(mat);
+    ScanSession *session = new ScanSession();
+    session->context = context;
+    session->gray = gray;
 
+    return session;
+}
+
+void write_bounding_box(const std::vector<cv::Point> &points, int width, int height, BoundingBox *bb_ptr) {
     bb_ptr->top_left.x = static_cast<double>(points[0].x) / width;
     bb_ptr->top_left.y = static_cast<double>(points[0].y) / height;
     bb_ptr->top_right.x = static_cast<double>(points[1].x) / width;
@@ -33,12 +134,63 @@ BoundingBox *detect_grid(const char *path) {
     bb_ptr->bottom_left.y = static_cast<double>(points[2].y) / height;
     bb_ptr->bottom_right.x = static_cast<double>(points[3].x) / width;
     bb_ptr->bottom_right.y = static_cast<double>(points[3].y) / height;
+}
+
+// White page with a bold 9x9 grid and some printed digits, enough for
+// every pipeline stage to do real work.
+cv::Mat make_warmup_image() {
+    const int size = GridDetector::RESOLUTION;
+    const int margin = size / 10;
+    const int cell_size = (size - 2 * margin) / 9;
+    cv::Mat image(size, size, CV_8UC1, cv::Scalar(255));
+
+    for (int i = 0; i <= 9; ++i) {
+        const int position = margin + i * cell_size;
+        const int thickness = i % 3 == 0 ? 4 : 2;
+        cv::line(image, cv::Point(margin, position), cv::Point(margin + 9 * cell_size, position), cv::Scalar(0), thickness);
+        cv::line(image, cv::Point(position, margin), cv::Point(position, margin + 9 * cell_size), cv::Scalar(0), thickness);
+    }
+
+    // one digit per row, in a different column each
+    for (int row = 0; row < 9; ++row) {
+        const int column = (row * 4) % 9;
+        const cv::Point origin(margin + column * cell_size + cell_size / 4, margin + (row + 1) * cell_size - cell_size / 5);
+        cv::putText(image, std::to_string(row + 1), origin, cv::FONT_HERSHEY_SIMPLEX, 1.0, cv::Scalar(0), 2);
+    }
+
+    return image;
+}
+
+// A negative size would turn into a huge size_t in the decoder.
+bool valid_bytes(const std::uint8_t *data, std::int32_t size) {
+    return data && size > 0;
+}
+
+bool valid_backend(std::int32_t backend) {
+    return backend >= BACKEND_AUTO && backend < BACKEND_COUNT;
+}
+
+BoundingBox *points_to_bounding_box(const std::vector<cv::Point> &points, int width, int height) {
+    BoundingBox *bb_ptr = new BoundingBox();
+    write_bounding_box(points, width, height, bb_ptr);
 
     return bb_ptr;
 }
 
-// TODO: try get image as byte array directly from dart
-std::uint8_t *extract_grid(const char *path, const BoundingBox *bounding_box) {
+BoundingBox *detect_grid_in_image(ScannerContext &context, cv::Mat &mat) {
+    int width = mat.size().width;
+    int height = mat.size().height;
+
+    if (width == 0 || height == 0) {
+        return new BoundingBox();
+    }
+
+    std::vector<cv::Point> points = GridDetector::detect_grid(mat, context.cascade);
+
+    return points_to_bounding_box(points, width, height);
+}
+
+std::uint8_t *extract_grid_in_image(ScannerContext &context, cv::Mat &mat, const BoundingBox *bounding_box, GridDetails *details = nullptr) {
     assert(bounding_box->top_left.x >= 0 && bounding_box->top_left.y >= 0);
     assert(bounding_box->top_right.x > 0 && bounding_box->top_right.y >= 0);
     assert(bounding_box->bottom_left.x >= 0 && bounding_box->bottom_left.y > 0);
@@ -52,10 +204,13 @@ std::uint8_t *extract_grid(const char *path, const BoundingBox *bounding_box) {
     assert(bounding_box->top_right.y <= bounding_box->bottom_left.y);
     assert(bounding_box->top_right.y <= bounding_box->bottom_right.y);
 
-    cv::Mat mat = cv::imread(path);
+    if (mat.empty()) {
+        return Grid().get_ownership();
+    }
 
     Grid grid = GridExtractor::extract_grid(
         mat,
+        context.classifier,
         bounding_box->top_left.x * mat.size().width,
         bounding_box->top_left.y * mat.size().height,
         bounding_box->top_right.x * mat.size().width,
@@ -63,18 +218,48 @@ std::uint8_t *extract_grid(const char *path, const BoundingBox *bounding_box) {
         bounding_box->bottom_left.x * mat.size().width,
         bounding_box->bottom_left.y * mat.size().height,
         bounding_box->bottom_right.x * mat.size().width,
-        bounding_box->bottom_right.y * mat.size().height);
+        bounding_box->bottom_right.y * mat.size().height,
+        details);
 
     return grid.get_ownership();
 }
 
-// TODO: try get image as byte array directly from dart
-std::uint8_t *extract_grid_from_roi(
-    const char *path,
+bool extract_grid_details_in_image(ScannerContext &context, cv::Mat &mat, const BoundingBox *bounding_box, GridResult *result) {
+    assert(result);
+
+    if (mat.empty()) {
+        *result = GridResult();
+        return false;
+    }
+
+    GridDetails details;
+    std::unique_ptr<std::uint8_t[]> grid(extract_grid_in_image(context, mat, bounding_box, &details));
+
+    for (std::size_t i = 0; i < details.size(); ++i) {
+        const CellDetails &cell = details[i];
+        CellResult &cell_result = result->cells[i];
+
+        cell_result.digit = cell.number;
+        std::copy(cell.probabilities.begin(), cell.probabilities.end(), cell_result.probabilities);
+        cell_result.x = cell.bounding_box.x;
+        cell_result.y = cell.bounding_box.y;
+        cell_result.width = cell.bounding_box.width;
+        cell_result.height = cell.bounding_box.height;
+        cell_result.blank_confidence = cell.blank_confidence;
+    }
+
+    return true;
+}
+
+std::uint8_t *extract_grid_from_roi_in_image(
+    ScannerContext &context,
+    cv::Mat &image,
     std::int32_t roi_size,
     // offset from center of image
     std::int32_t roi_offset) {
-    cv::Mat image = cv::imread(path);
+    if (image.empty()) {
+        return Grid().get_ownership();
+    }
 
     assert(roi_size > 0 && roi_size <= image.size().width);
     assert(abs(roi_offset) <= (image.size().height - roi_size) / 2);
@@ -89,11 +274,12 @@ std::uint8_t *extract_grid_from_roi(
     image = image(roi);
     cv::Mat image_copy = image.clone();
 
-    std::vector<cv::Point> points = GridDetector::detect_grid(image);
+    std::vector<cv::Point> points = GridDetector::detect_grid(image, context.cascade);
     image.release();
 
     Grid grid = GridExtractor::extract_grid(
         image_copy,
+        context.classifier,
         points[0].x,
         points[0].y,
         points[1].x,
@@ -106,8 +292,350 @@ std::uint8_t *extract_grid_from_roi(
     return grid.get_ownership();
 }
 
-void set_model(const char *path) {
-    setenv(PATH_TO_MODEL_ENV_VAR, path, 1);
+}  // namespace
+
+ScannerContext *scanner_create(const char *model_path, std::int32_t backend) {
+    if (!valid_backend(backend)) {
+        return nullptr;
+    }
+
+    std::unique_ptr<ScannerContext> context(new ScannerContext());
+
+    if (!context->classifier.load_model(model_path, static_cast<InferenceBackend>(backend))) {
+        return nullptr;
+    }
+
+    return context.release();
+}
+
+ScannerContext *scanner_create_from_buffer(const std::uint8_t *model_data, std::int32_t size, std::int32_t backend) {
+    if (!valid_bytes(model_data, size) || !valid_backend(backend)) {
+        return nullptr;
+    }
+
+    std::unique_ptr<ScannerContext> context(new ScannerContext());
+
+    if (!context->classifier.load_model(model_data, size, static_cast<InferenceBackend>(backend))) {
+        return nullptr;
+    }
+
+    return context.release();
+}
+
+bool scanner_warmup(ScannerContext *context) {
+    assert(context);
+
+    if (!context->classifier.warm_up()) {
+        return false;
+    }
+
+    // own cascade state, so the context's statistics and tuning stay untouched
+    CascadeState cascade;
+    cv::Mat image = make_warmup_image();
+    cv::Mat detection_image = image.clone();
+
+    std::vector<cv::Point> points = GridDetector::detect_grid(detection_image, cascade);
+    GridExtractor::extract_grid(image, context->classifier, points[0].x, points[0].y, points[1].x, points[1].y,
+                                points[2].x, points[2].y, points[3].x, points[3].y);
+
+    return true;
+}
+
+void scanner_destroy(ScannerContext *context) {
+    delete context;
+}
+
+BoundingBox *detect_grid(ScannerContext *context, const char *path) {
+    assert(context);
+    SCAN_TRACE(context->history);
+
+    cv::Size size;
+    int factor = ImageDecoder::read_size(path, size) ? detection_factor(size) : 1;
+
+    cv::Mat mat = ImageDecoder::decode_reduced(path, factor);
+    return detect_grid_in_image(*context, mat);
+}
+
+BoundingBox *detect_grid_from_bytes(ScannerContext *context, const std::uint8_t *data, std::int32_t size) {
+    assert(context);
+    SCAN_TRACE(context->history);
+
+    if (!valid_bytes(data, size)) {
+        return new BoundingBox();
+    }
+
+    cv::Size image_size;
+    int factor = ImageDecoder::read_size(data, size, image_size) ? detection_factor(image_size) : 1;
+
+    cv::Mat mat = ImageDecoder::decode_reduced(data, size, factor);
+    return detect_grid_in_image(*context, mat);
+}
+
+std::uint8_t *extract_grid(ScannerContext *context, const char *path, const BoundingBox *bounding_box) {
+    assert(context);
+    SCAN_TRACE(context->history);
+
+    cv::Size size;
+    int factor = ImageDecoder::read_size(path, size) ? extraction_factor(size, bounding_box) : 1;
+
+    cv::Mat mat = ImageDecoder::decode_reduced(path, factor);
+    return extract_grid_in_image(*context, mat, bounding_box);
+}
+
+std::uint8_t *extract_grid_from_bytes(ScannerContext *context, const std::uint8_t *data, std::int32_t size, const BoundingBox *bounding_box) {
+    assert(context);
+    SCAN_TRACE(context->history);
+
+    if (!valid_bytes(data, size)) {
+        return Grid().get_ownership();
+    }
+
+    cv::Size image_size;
+    int factor = ImageDecoder::read_size(data, size, image_size) ? extraction_factor(image_size, bounding_box) : 1;
+
+    cv::Mat mat = ImageDecoder::decode_reduced(data, size, factor);
+    return extract_grid_in_image(*context, mat, bounding_box);
+}
+
+bool extract_grid_details(ScannerContext *context, const char *path, const BoundingBox *bounding_box, GridResult *result) {
+    assert(context);
+    SCAN_TRACE(context->history);
+
+    cv::Size size;
+    int factor = ImageDecoder::read_size(path, size) ? extraction_factor(size, bounding_box) : 1;
+
+    cv::Mat mat = ImageDecoder::decode_reduced(path, factor);
+    return extract_grid_details_in_image(*context, mat, bounding_box, result);
+}
+
+// ROI is given in full resolution pixels, so no reduced decoding here
+std::uint8_t *extract_grid_from_roi(ScannerContext *context, const char *path, std::int32_t roi_size, std::int32_t roi_offset) {
+    assert(context);
+    SCAN_TRACE(context->history);
+
+    cv::Mat image = ImageDecoder::decode(path);
+    return extract_grid_from_roi_in_image(*context, image, roi_size, roi_offset);
+}
+
+std::uint8_t *extract_grid_from_roi_bytes(ScannerContext *context, const std::uint8_t *data, std::int32_t size, std::int32_t roi_size, std::int32_t roi_offset) {
+    assert(context);
+    SCAN_TRACE(context->history);
+
+    if (!valid_bytes(data, size)) {
+        return Grid().get_ownership();
+    }
+
+    cv::Mat image = ImageDecoder::decode(data, size);
+    return extract_grid_from_roi_in_image(*context, image, roi_size, roi_offset);
+}
+
+BoundingBox *detect_grid_from_frame(ScannerContext *context, const YuvFrame *frame) {
+    assert(context);
+    SCAN_TRACE(context->history);
+
+    cv::Mat gray = frame_to_gray(frame);
+    return detect_grid_in_image(*context, gray);
+}
+
+std::uint8_t *extract_grid_from_frame(ScannerContext *context, const YuvFrame *frame, const BoundingBox *bounding_box) {
+    assert(context);
+    SCAN_TRACE(context->history);
+
+    cv::Mat gray = frame_to_gray(frame);
+    return extract_grid_in_image(*context, gray, bounding_box);
+}
+
+std::uint8_t *extract_grid_from_roi_frame(ScannerContext *context, const YuvFrame *frame, std::int32_t roi_size, std::int32_t roi_offset) {
+    assert(context);
+    SCAN_TRACE(context->history);
+
+    cv::Mat gray = frame_to_gray(frame);
+    return extract_grid_from_roi_in_image(*context, gray, roi_size, roi_offset);
+}
+
+// sessions keep full resolution, the bounding box isn't known yet
+ScanSession *scan_open(ScannerContext *context, const char *path) {
+    assert(context);
+    SCAN_TRACE(context->history);
+
+    return open_session(context, ImageDecoder::decode(path));
+}
+
+ScanSession *scan_open_from_bytes(ScannerContext *context, const std::uint8_t *data, std::int32_t size) {
+    assert(context);
+    SCAN_TRACE(context->history);
+
+    if (!valid_bytes(data, size)) {
+        return nullptr;
+    }
+
+    return open_session(context, ImageDecoder::decode(data, size));
+}
+
+BoundingBox *scan_detect(ScanSession *session) {
+    assert(session);
+    SCAN_TRACE(session->context->history);
+
+    if (session->detection_image.empty()) {
+        session->detection_image = GridDetector::preprocess(session->gray);
+    }
+
+    cv::Size size = session->gray.size();
+    std::vector<cv::Point> points = GridDetector::detect_grid(session->detection_image, size, session->context->cascade);
+
+    return points_to_bounding_box(points, size.width, size.height);
+}
+
+std::uint8_t *scan_extract(ScanSession *session, const BoundingBox *bounding_box) {
+    assert(session);
+    SCAN_TRACE(session->context->history);
+
+    // extraction replaces the Mat it gets, so hand over a shallow copy
+    cv::Mat gray = session->gray;
+    return extract_grid_in_image(*session->context, gray, bounding_box);
+}
+
+bool scan_extract_details(ScanSession *session, const BoundingBox *bounding_box, GridResult *result) {
+    assert(session);
+    SCAN_TRACE(session->context->history);
+
+    cv::Mat gray = session->gray;
+    return extract_grid_details_in_image(*session->context, gray, bounding_box, result);
+}
+
+void scan_close(ScanSession *session) {
+    delete session;
+}
+
+TrackingSession *track_open(ScannerContext *context) {
+    assert(context);
+
+    TrackingSession *session = new TrackingSession();
+    session->context = context;
+
+    return session;
+}
+
+std::int32_t track_frame(TrackingSession *session, const YuvFrame *frame, BoundingBox *bounding_box) {
+    assert(session && bounding_box);
+    SCAN_TRACE(session->context->history);
+
+    cv::Mat gray = frame_to_gray(frame);
+
+    if (gray.empty()) {
+        return TRACK_NONE;
+    }
+
+    std::vector<cv::Point> points;
+
+    switch (session->tracker.track(gray, session->context->cascade, points)) {
+        case GridTracker::Result::TRACKED:
+            write_bounding_box(points, gray.size().width, gray.size().height, bounding_box);
+            return TRACK_TRACKED;
+        case GridTracker::Result::DETECTED:
+            write_bounding_box(points, gray.size().width, gray.size().height, bounding_box);
+            return TRACK_DETECTED;
+        default:
+            return TRACK_NONE;
+    }
+}
+
+void track_reset(TrackingSession *session) {
+    assert(session);
+    session->tracker.reset();
+}
+
+void track_close(TrackingSession *session) {
+    delete session;
+}
+
+bool solve_grid(const std::uint8_t *grid, std::uint8_t *solution) {
+    assert(grid && solution);
+
+    return SudokuSolver::solve(grid, solution);
+}
+
+std::int32_t count_solutions(const std::uint8_t *grid, std::int32_t limit) {
+    assert(grid);
+
+    return SudokuSolver::count_solutions(grid, limit);
+}
+
+void set_parallel_detection(ScannerContext *context, bool enabled) {
+    assert(context);
+    context->cascade.parallel = enabled;
+}
+
+void set_adaptive_detection(ScannerContext *context, bool enabled) {
+    assert(context);
+    context->cascade.adaptive = enabled;
+}
+
+void get_detection_statistics(ScannerContext *context, DetectionStatistics *statistics) {
+    assert(context && statistics);
+
+    CascadeStatistics cascade = context->cascade.get_statistics();
+
+    statistics->detections = cascade.detections;
+    statistics->successes = cascade.successes;
+    statistics->threshold_passes = cascade.threshold_passes;
+    std::copy(std::begin(cascade.setting_successes), std::end(cascade.setting_successes), statistics->setting_successes);
+}
+
+void reset_detection_statistics(ScannerContext *context) {
+    assert(context);
+    context->cascade.reset_statistics();
+}
+
+void get_backend_info(ScannerContext *context, BackendInfo *info) {
+    assert(context && info);
+
+    BackendSelection selection = context->classifier.get_backend();
+
+    info->backend = static_cast<std::int32_t>(selection.backend);
+    info->threads = selection.threads;
+    std::copy(std::begin(selection.benchmark_us), std::end(selection.benchmark_us), info->benchmark_us);
+    info->cached = selection.cached;
+    info->model_hash = context->classifier.get_model_hash();
+}
+
+void get_classifier_statistics(ScannerContext *context, ClassifierStatistics *statistics) {
+    assert(context && statistics);
+
+    InterpreterPoolStatistics pool = context->classifier.get_statistics();
+
+    statistics->pool_size = pool.pool_size;
+    statistics->checkouts = pool.checkouts;
+    statistics->contended_checkouts = pool.contended_checkouts;
+    statistics->peak_in_use = pool.peak_in_use;
+}
+
+void get_scan_stats(ScannerContext *context, ScanStats *stats) {
+    assert(context && stats);
+
+    ScanRecord record = context->history.last();
+    auto microseconds = [&record](ScanStage stage) {
+        return static_cast<std::uint32_t>(record.stage_nanoseconds[static_cast<int>(stage)] / 1000);
+    };
+    auto counter = [&record](ScanCounter counter) {
+        return record.counters[static_cast<int>(counter)];
+    };
+
+    stats->decode_us = microseconds(ScanStage::DECODE);
+    stats->preprocess_us = microseconds(ScanStage::PREPROCESS);
+    stats->locate_grid_us = microseconds(ScanStage::LOCATE_GRID);
+    stats->warp_us = microseconds(ScanStage::WARP);
+    stats->binarize_us = microseconds(ScanStage::BINARIZE);
+    stats->remove_grid_lines_us = microseconds(ScanStage::REMOVE_GRID_LINES);
+    stats->extract_cells_us = microseconds(ScanStage::EXTRACT_CELLS);
+    stats->predict_numbers_us = microseconds(ScanStage::PREDICT_NUMBERS);
+    stats->correct_numbers_us = microseconds(ScanStage::CORRECT_NUMBERS);
+    stats->threshold_passes = counter(ScanCounter::THRESHOLD_PASSES);
+    stats->quadrilaterals = counter(ScanCounter::QUADRILATERALS);
+    stats->rejected_quadrilaterals = counter(ScanCounter::REJECTED_QUADRILATERALS);
+    stats->cells = counter(ScanCounter::CELLS);
+    stats->corrected_cells = counter(ScanCounter::CORRECTED_CELLS);
+    stats->enabled = ScanProfiler::is_enabled();
 }
 
 void free_pointer(void *pointer) {
@@ -4,9 +4,11 @@
 #ifdef __cplusplus
 #define FFI_EXPORT extern "C" __attribute__((visibility("default"))) __attribute__((used))
 #include <cstdint>
+using std::int32_t;
 using std::uint32_t;
 using std::uint8_t;
 #else
+#include <stdbool.h>
 #include <stdint.h>
 #define FFI_EXPORT __attribute__((visibility("default"))) __attribute__((used))
 #endif
@@ -23,13 +25,241 @@ struct BoundingBox {
     struct Offset bottom_right;
 };
 
-FFI_EXPORT struct BoundingBox *detect_grid(const char *path);
+#define THRESHOLD_SETTING_COUNT 5
 
-FFI_EXPORT uint8_t *extract_grid(const char *path, const struct BoundingBox *bounding_box);
+// Collected over all grid detections since the last reset.
+struct DetectionStatistics {
+    uint32_t detections;
+    uint32_t successes;
+    // mean passes per detection is threshold_passes / detections
+    uint32_t threshold_passes;
+    // successes per threshold setting, in original priority order
+    uint32_t setting_successes[THRESHOLD_SETTING_COUNT];
+};
+
+// Inference backends of the digit classifier. BACKEND_AUTO benchmarks the
+// others on the device once per process and model and picks the fastest.
+#define BACKEND_AUTO -1
+#define BACKEND_CPU 0
+#define BACKEND_XNNPACK 1
+#define BACKEND_NNAPI 2
+#define BACKEND_COUNT 3
+
+// Backend a context classifies with and how it got chosen.
+struct BackendInfo {
+    int32_t backend;
+    // cpu threads per interpreter, used by BACKEND_CPU and BACKEND_XNNPACK
+    int32_t threads;
+    // median full grid inference per backend (microseconds), 0 if
+    // unavailable or not measured; from the earlier benchmark if cached
+    uint32_t benchmark_us[BACKEND_COUNT];
+    // taken from an earlier benchmark in this process
+    bool cached;
+    // FNV-1a hash of the model flatbuffer, tells whether a stored choice was
+    // made for the same model
+    uint64_t model_hash;
+};
+
+// Usage of the classifier's interpreter pool since the context was created.
+// Classification waits only if more scans run at once than the pool has
+// interpreters, which shows in contended_checkouts.
+struct ClassifierStatistics {
+    uint32_t pool_size;
+    uint32_t checkouts;
+    uint32_t contended_checkouts;
+    // most interpreters in use at the same time
+    uint32_t peak_in_use;
+};
+
+// Stage timings (microseconds) and counters of the latest scan on a context.
+// Every call only replaces the stages it ran, so after scan_detect and scan_extract the
+// whole scan is covered. All 0 if the library was built without SCAN_STATS.
+struct ScanStats {
+    uint32_t decode_us;
+    uint32_t preprocess_us;
+    uint32_t locate_grid_us;
+    uint32_t warp_us;
+    uint32_t binarize_us;
+    uint32_t remove_grid_lines_us;
+    uint32_t extract_cells_us;
+    uint32_t predict_numbers_us;
+    uint32_t correct_numbers_us;
+    uint32_t threshold_passes;
+    // four-cornered contours found during detection and how many of them
+    // were rejected as not square enough
+    uint32_t quadrilaterals;
+    uint32_t rejected_quadrilaterals;
+    // cells holding a digit and digits changed by the Sudoku rules
+    uint32_t cells;
+    uint32_t corrected_cells;
+    bool enabled;
+};
+
+// side length of the perspective corrected grid image
+#define WARPED_GRID_SIZE 450
+
+// Everything extraction knows about one cell.
+struct CellResult {
+    // 0 for blank cells
+    uint8_t digit;
+    // classifier output for the digits 1 to 9, all 0 for blank cells
+    float probabilities[9];
+    // bounding box of the digit in the warped grid image (WARPED_GRID_SIZE
+    // pixels wide), all 0 for blank cells
+    int32_t x;
+    int32_t y;
+    int32_t width;
+    int32_t height;
+    // 1 without any ink around the cell center, falling to 0 as ink grows
+    // to the size of a digit
+    float blank_confidence;
+};
+
+// row-major
+struct GridResult {
+    struct CellResult cells[81];
+};
+
+// Raw YUV_420_888 / NV21 camera frame. Only the Y plane is read, it is used
+// as grayscale input. The chroma planes are optional and may be null.
+struct YuvFrame {
+    const uint8_t *y_plane;
+    const uint8_t *u_plane;
+    const uint8_t *v_plane;
+    int32_t width;
+    int32_t height;
+    int32_t y_row_stride;
+    int32_t uv_row_stride;
+    int32_t uv_pixel_stride;
+    // clockwise rotation (0, 90, 180, 270) to get the upright image
+    int32_t rotation;
+};
+
+// A scanner context owns the classifier model plus the detection tuning and
+// statistics, every scan runs on one. Scans on the same or on different
+// contexts may run concurrently from any thread, the model is shared by a
+// pool of interpreters (one per core, at most 4) so concurrent scans
+// classify in parallel. The model runs on backend (one of BACKEND_*), or
+// on CPU if that is not available here. Apps can store the backend that
+// BACKEND_AUTO picked (see get_backend_info) and pass it on later launches
+// to skip the benchmark. Returns null if the model could not be loaded.
+
+struct ScannerContext;
+
+FFI_EXPORT struct ScannerContext *scanner_create(const char *model_path, int32_t backend);
+
+// Same as scanner_create, but takes the model file (e.g. straight from the
+// app's assets) from memory. The bytes are copied, so they can be freed
+// right after the call.
+FFI_EXPORT struct ScannerContext *scanner_create_from_buffer(const uint8_t *model_data, int32_t size, int32_t backend);
+
+// Runs the classifier on blank input with every free interpreter of the pool
+// and the whole pipeline once on a synthetic grid, so the first real scan does
+// not pay for delegate preparation, tensor allocation and lazy library
+// initialization. Blocks until done, meant to be called from a background
+// thread right after scanner_create. Scans may run meanwhile. Detection
+// statistics and tuning of the context are not affected. Returns false if
+// inference failed.
+FFI_EXPORT bool scanner_warmup(struct ScannerContext *context);
+
+// Sessions opened on the context must be closed and no scan may be running.
+FFI_EXPORT void scanner_destroy(struct ScannerContext *context);
+
+FFI_EXPORT struct BoundingBox *detect_grid(struct ScannerContext *context, const char *path);
+
+FFI_EXPORT uint8_t *extract_grid(struct ScannerContext *context, const char *path, const struct BoundingBox *bounding_box);
+
+FFI_EXPORT uint8_t *extract_grid_from_roi(struct ScannerContext *context, const char *path, int32_t roi_size, int32_t roi_offset);
+
+// Same as extract_grid, but writes the details of every cell into the given
+// memory instead of allocating. Returns false if the image could not be read.
+FFI_EXPORT bool extract_grid_details(struct ScannerContext *context, const char *path, const struct BoundingBox *bounding_box, struct GridResult *result);
+
+// Variants of the above taking an encoded image (e.g. JPEG) from memory.
+// The buffer is only read during the call and is not copied.
+
+FFI_EXPORT struct BoundingBox *detect_grid_from_bytes(struct ScannerContext *context, const uint8_t *data, int32_t size);
+
+FFI_EXPORT uint8_t *extract_grid_from_bytes(struct ScannerContext *context, const uint8_t *data, int32_t size, const struct BoundingBox *bounding_box);
+
+FFI_EXPORT uint8_t *extract_grid_from_roi_bytes(struct ScannerContext *context, const uint8_t *data, int32_t size, int32_t roi_size, int32_t roi_offset);
+
+// Variants taking a raw camera frame, e.g. from the preview image stream.
+// The frame is only read during the call and is not copied unless rotated.
+
+FFI_EXPORT struct BoundingBox *detect_grid_from_frame(struct ScannerContext *context, const struct YuvFrame *frame);
+
+FFI_EXPORT uint8_t *extract_grid_from_frame(struct ScannerContext *context, const struct YuvFrame *frame, const struct BoundingBox *bounding_box);
+
+FFI_EXPORT uint8_t *extract_grid_from_roi_frame(struct ScannerContext *context, const struct YuvFrame *frame, int32_t roi_size, int32_t roi_offset);
+
+// A scan session decodes the image once and keeps it (plus the downscaled
+// detection image) around, so repeated detection and extraction on the same
+// image, e.g. after moving a corner, skip decoding. Returns null if the image
+// could not be decoded. Sessions keep using the context they were opened on.
+
+struct ScanSession;
+
+FFI_EXPORT struct ScanSession *scan_open(struct ScannerContext *context, const char *path);
+
+FFI_EXPORT struct ScanSession *scan_open_from_bytes(struct ScannerContext *context, const uint8_t *data, int32_t size);
+
+FFI_EXPORT struct BoundingBox *scan_detect(struct ScanSession *session);
+
+FFI_EXPORT uint8_t *scan_extract(struct ScanSession *session, const struct BoundingBox *bounding_box);
+
+FFI_EXPORT bool scan_extract_details(struct ScanSession *session, const struct BoundingBox *bounding_box, struct GridResult *result);
+
+FFI_EXPORT void scan_close(struct ScanSession *session);
+
+// Live tracking on the camera preview stream. Each frame either follows the
+// grid of the previous frame or falls back to a full detection, which also
+// runs at least every 30 frames to correct drift. The
+// bounding box is written into the given memory, the return value is one of
+// TRACK_NONE, TRACK_TRACKED or TRACK_DETECTED.
+
+#define TRACK_NONE 0
+#define TRACK_TRACKED 1
+#define TRACK_DETECTED 2
+
+struct TrackingSession;
+
+FFI_EXPORT struct TrackingSession *track_open(struct ScannerContext *context);
+
+FFI_EXPORT int32_t track_frame(struct TrackingSession *session, const struct YuvFrame *frame, struct BoundingBox *bounding_box);
+
+FFI_EXPORT void track_reset(struct TrackingSession *session);
+
+FFI_EXPORT void track_close(struct TrackingSession *session);
+
+// Solves the 81 values of grid (row-major, 0 for empty cells) and writes the
+// solution into the 81 bytes of solution. Returns false if the grid
+// contradicts itself or has no solution. Both may point to the same memory.
+FFI_EXPORT bool solve_grid(const uint8_t *grid, uint8_t *solution);
+
+// Counts the solutions of grid, but stops at limit. A limit of 2 tells
+// whether a scanned grid is a proper Sudoku (exactly one solution), has
+// none (e.g. a misread digit) or several (e.g. a missed digit). Returns 0 if
+// limit is not positive.
+FFI_EXPORT int32_t count_solutions(const uint8_t *grid, int32_t limit);
+
+// Lets detection evaluate all threshold settings in parallel. Lowers worst
+// case latency on multi-core devices at the cost of more total work.
+FFI_EXPORT void set_parallel_detection(struct ScannerContext *context, bool enabled);
+
+// Lets detection try the threshold settings that succeeded most often for
+// similar lighting (brightness and contrast) first.
+FFI_EXPORT void set_adaptive_detection(struct ScannerContext *context, bool enabled);
+
+FFI_EXPORT void get_detection_statistics(struct ScannerContext *context, struct DetectionStatistics *statistics);
+
+FFI_EXPORT void reset_detection_statistics(struct ScannerContext *context);
+
+FFI_EXPORT void get_backend_info(struct ScannerContext *context, struct BackendInfo *info);
 
-FFI_EXPORT uint8_t *extract_grid_from_roi(const char *path, int32_t roi_size, int32_t roi_offset);
+FFI_EXPORT void get_classifier_statistics(struct ScannerContext *context, struct ClassifierStatistics *statistics);
 
-FFI_EXPORT void set_model(const char *path);
+FFI_EXPORT void get_scan_stats(struct ScannerContext *context, struct ScanStats *stats);
 
 FFI_EXPORT void free_pointer(void *pointer);
 
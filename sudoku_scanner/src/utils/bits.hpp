@@ -0,0 +1,43 @@
+#ifndef BITS_HPP
+#define BITS_HPP
+
+#include <cstdint>
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+
+// Bit tricks on masks of digits and pool slots. Compiler intrinsics where
+// available, plain C++ otherwise.
+class Bits {
+   public:
+    Bits() = delete;
+
+    // number of set bits
+    static int count(std::uint64_t mask) {
+#if defined(__GNUC__) || defined(__clang__)
+        return __builtin_popcountll(mask);
+#else
+        int result = 0;
+        for (; mask; mask &= mask - 1) ++result;
+        return result;
+#endif
+    }
+
+    // index of the lowest set bit, mask must not be 0
+    static int lowest(std::uint64_t mask) {
+#if defined(__GNUC__) || defined(__clang__)
+        return __builtin_ctzll(mask);
+#elif defined(_MSC_VER) && defined(_M_X64)
+        unsigned long index;
+        _BitScanForward64(&index, mask);
+        return static_cast<int>(index);
+#else
+        int index = 0;
+        for (; !(mask & 1); mask >>= 1) ++index;
+        return index;
+#endif
+    }
+};
+
+#endif